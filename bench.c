@@ -0,0 +1,1066 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "nand_hal.h"
+#include "ftl.h"
+#include "ftl_victim.h"
+#include "nvme.h"
+#include "ftl_async.h"
+
+// 벤치마크 모음: ./ftl_bench <name>   (인자 없으면 전부 실행)
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// ---------------------------------------------------------------
+// gc-pick: full block-table scan vs victim index
+// GC 한 번 = victim 선택 + 제거 + (erase 후 재사용되어) 다시 closed 상태로 삽입
+// ---------------------------------------------------------------
+static int scan_pick(const int *invalid, const int *is_free, int nblocks) {
+    int victim = -1, max = -1;
+    for (int i = 0; i < nblocks; i++) {
+        if (is_free[i]) continue;
+        if (invalid[i] > max) { max = invalid[i]; victim = i; }
+    }
+    return victim;
+}
+
+static void bench_gc_pick(void) {
+    const int sizes[] = { 1024, 64 * 1024, 1024 * 1024 };
+    const int picks = 2000;
+
+    printf("[gc-pick] %-10s %14s %14s\n", "blocks", "scan ns/pick", "index ns/pick");
+    for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int n = sizes[s];
+        int *invalid = (int *)malloc(sizeof(int) * n);
+        int *is_free = (int *)calloc(n, sizeof(int));
+        victim_index_t vi;
+        if (!invalid || !is_free || victim_index_init(&vi, n, PAGES_PER_BLOCK, 0, 1) != 0) {
+            printf("[gc-pick] alloc failed at %d blocks\n", n);
+            free(invalid); free(is_free);
+            return;
+        }
+
+        srand(1234);
+        for (int i = 0; i < n; i++) {
+            invalid[i] = rand() % (PAGES_PER_BLOCK + 1);
+            victim_index_insert(&vi, i, invalid[i]);
+        }
+
+        volatile int sink = 0;
+        double t0 = now_sec();
+        for (int k = 0; k < picks; k++) {
+            int v = scan_pick(invalid, is_free, n);
+            invalid[v] = rand() % (PAGES_PER_BLOCK / 2);   // 재사용된 block이 다시 closed
+            sink += v;
+        }
+        double t_scan = now_sec() - t0;
+
+        t0 = now_sec();
+        for (int k = 0; k < picks; k++) {
+            int v = victim_index_pick(&vi);
+            victim_index_remove(&vi, v);
+            victim_index_insert(&vi, v, rand() % (PAGES_PER_BLOCK / 2));
+            sink += v;
+        }
+        double t_idx = now_sec() - t0;
+        (void)sink;
+
+        printf("[gc-pick] %-10d %14.1f %14.1f\n", n, t_scan * 1e9 / picks, t_idx * 1e9 / picks);
+        victim_index_free(&vi);
+        free(invalid);
+        free(is_free);
+    }
+}
+
+// ---------------------------------------------------------------
+// init: nand_init() + nand_exit() cost per backend
+// ---------------------------------------------------------------
+static void bench_init(void) {
+    const struct { const char *name; nand_backend_t backend; } modes[] = {
+        { "ram", NAND_BACKEND_RAM },
+        { "sparse", NAND_BACKEND_SPARSE },
+        { "file", NAND_BACKEND_FILE },
+    };
+
+    for (unsigned m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        nand_config_t cfg = { .backend = modes[m].backend, .image_path = "ftl_bench.img" };
+        double t0 = now_sec();
+        if (nand_init(&cfg) != NAND_SUCCESS) {
+            printf("[init] %s: nand_init failed\n", modes[m].name);
+            continue;
+        }
+        double t_init = now_sec() - t0;
+        uint32_t resident = nand_get_resident_pages();
+        nand_exit();
+        printf("[init] %-8s init %8.2f ms, resident pages %u\n", modes[m].name, t_init * 1e3, resident);
+    }
+    unlink("ftl_bench.img");
+}
+
+// ---------------------------------------------------------------
+// oob-scan: full-chip OOB scan (GC가 하는 nand_read(ppa, NULL, oob) 패턴)
+// 두 layout을 같은 방식 (raw loop, lock / timing 없음)으로 비교
+// interleaved = 예전 page 구조체 배열, split = HAL의 OOB 배열 + block 별 written bitmap
+// ---------------------------------------------------------------
+typedef struct {
+    uint8_t data[NAND_DEFAULT_PAGE_SIZE];
+    uint8_t oob[NAND_DEFAULT_OOB_SIZE];
+    uint8_t is_written;
+} aos_page_t;
+
+#define OOB_SCAN_WORDS  ((NAND_DEFAULT_PAGES_PER_BLOCK + 63) / 64)
+
+static void bench_oob_scan(void) {
+    const int total = NAND_DEFAULT_BLOCKS * NAND_DEFAULT_PAGES_PER_BLOCK;
+    const int rounds = 20;
+    uint8_t oob[NAND_DEFAULT_OOB_SIZE];
+    uint32_t sum = 0;
+
+    aos_page_t *aos = (aos_page_t *)malloc(sizeof(aos_page_t) * total);
+    if (!aos) { printf("[oob-scan] alloc failed\n"); return; }
+    for (int p = 0; p < total; p++) {
+        memset(aos[p].data, 0xAB, sizeof(aos[p].data));
+        memset(aos[p].oob, p & 0xFF, sizeof(aos[p].oob));
+        aos[p].is_written = 1;
+    }
+    double t0 = now_sec();
+    for (int r = 0; r < rounds; r++) {
+        for (int p = 0; p < total; p++) {
+            if (!aos[p].is_written) continue;
+            memcpy(oob, aos[p].oob, sizeof(aos[p].oob));
+            sum += oob[0];
+        }
+    }
+    double t_aos = (now_sec() - t0) / rounds;
+    free(aos);
+
+    // page data는 OOB scan에서 건드리지 않으므로 따로 둘 필요 없음
+    uint8_t *soa_oob = (uint8_t *)malloc((size_t)total * NAND_DEFAULT_OOB_SIZE);
+    uint64_t *written = (uint64_t *)calloc((size_t)NAND_DEFAULT_BLOCKS * OOB_SCAN_WORDS, sizeof(uint64_t));
+    if (!soa_oob || !written) { free(soa_oob); free(written); printf("[oob-scan] alloc failed\n"); return; }
+    for (int p = 0; p < total; p++) {
+        int block = p / NAND_DEFAULT_PAGES_PER_BLOCK, page = p % NAND_DEFAULT_PAGES_PER_BLOCK;
+        memset(soa_oob + (size_t)p * NAND_DEFAULT_OOB_SIZE, p & 0xFF, NAND_DEFAULT_OOB_SIZE);
+        written[(size_t)block * OOB_SCAN_WORDS + page / 64] |= 1ULL << (page % 64);
+    }
+    t0 = now_sec();
+    for (int r = 0; r < rounds; r++) {
+        for (int p = 0; p < total; p++) {
+            int block = p / NAND_DEFAULT_PAGES_PER_BLOCK, page = p % NAND_DEFAULT_PAGES_PER_BLOCK;
+            if (!((written[(size_t)block * OOB_SCAN_WORDS + page / 64] >> (page % 64)) & 1)) continue;
+            memcpy(oob, soa_oob + (size_t)p * NAND_DEFAULT_OOB_SIZE, NAND_DEFAULT_OOB_SIZE);
+            sum += oob[0];
+        }
+    }
+    double t_soa = (now_sec() - t0) / rounds;
+    free(soa_oob);
+    free(written);
+
+    printf("[oob-scan] %d pages: interleaved %.2f ms, split arrays %.2f ms (x%.1f) [%u]\n",
+           total, t_aos * 1e3, t_soa * 1e3, t_aos / t_soa, sum & 1);
+}
+
+// ---------------------------------------------------------------
+// mt-io: submitter thread 수 1..N 에서 read/write 혼합 처리량 (background GC thread 동작 중)
+// thread t는 lba % threads == t 인 LBA만 써서 끝난 뒤 마지막 값을 검증할 수 있음
+// ---------------------------------------------------------------
+#define MT_MAX_THREADS  8
+#define MT_TOTAL_OPS    400000
+#define MT_SPAN         (LOGICAL_PAGES_COUNT * 9 / 10)
+
+typedef struct {
+    int id;
+    int threads;
+    int ops;
+    uint32_t *seq;      // lba 별 마지막으로 쓴 seq (0 = 아직 안 씀), 이 thread 소유 LBA만
+} mt_arg_t;
+
+static void *mt_worker(void *p) {
+    mt_arg_t *a = (mt_arg_t *)p;
+    uint8_t buf[NAND_PAGE_SIZE];
+    unsigned seed = 77 + a->id;
+    int owned = (MT_SPAN - a->id + a->threads - 1) / a->threads;
+
+    for (int i = 0; i < a->ops; i++) {
+        uint32_t lba = (uint32_t)(rand_r(&seed) % owned) * a->threads + a->id;
+        if (rand_r(&seed) % 10 < 3) {
+            ftl_read(lba, buf);
+            continue;
+        }
+        uint32_t seq = (uint32_t)i + 1;
+        memset(buf, (int)(seq & 0xFF), NAND_PAGE_SIZE);
+        memcpy(buf, &lba, sizeof(lba));
+        memcpy(buf + sizeof(lba), &seq, sizeof(seq));
+        ftl_write(lba, buf);
+        a->seq[lba] = seq;
+    }
+    return NULL;
+}
+
+static void bench_mt_io(void) {
+    nand_config_t cfg = { .backend = NAND_BACKEND_RAM, .no_timing = 1 };
+    uint32_t *seq = (uint32_t *)malloc(sizeof(uint32_t) * LOGICAL_PAGES_COUNT);
+    double base = 0;
+    if (!seq) { printf("[mt-io] alloc failed\n"); return; }
+
+    printf("[mt-io] %d ops (70%% write), span %u pages\n", MT_TOTAL_OPS, MT_SPAN);
+    for (int threads = 1; threads <= MT_MAX_THREADS; threads *= 2) {
+        pthread_t tid[MT_MAX_THREADS];
+        mt_arg_t args[MT_MAX_THREADS];
+        ftl_stats_t st;
+
+        memset(seq, 0, sizeof(uint32_t) * LOGICAL_PAGES_COUNT);
+        if (ftl_init(&cfg) != 0) { printf("[mt-io] ftl_init failed\n"); break; }
+        ftl_bg_gc_start();
+
+        double t0 = now_sec();
+        for (int t = 0; t < threads; t++) {
+            args[t] = (mt_arg_t){ t, threads, MT_TOTAL_OPS / threads, seq };
+            pthread_create(&tid[t], NULL, mt_worker, &args[t]);
+        }
+        for (int t = 0; t < threads; t++) pthread_join(tid[t], NULL);
+        double elapsed = now_sec() - t0;
+        ftl_bg_gc_stop();
+
+        // 각 LBA는 한 thread만 썼으므로 마지막 seq가 남아 있어야 함
+        uint8_t buf[NAND_PAGE_SIZE];
+        int bad = 0;
+        for (uint32_t lba = 0; lba < MT_SPAN; lba++) {
+            if (!seq[lba]) continue;
+            uint32_t got_lba, got_seq;
+            ftl_read(lba, buf);
+            memcpy(&got_lba, buf, sizeof(got_lba));
+            memcpy(&got_seq, buf + sizeof(got_lba), sizeof(got_seq));
+            if (got_lba != lba || got_seq != seq[lba]) bad++;
+        }
+        ftl_get_stats(&st);
+        ftl_exit();
+
+        double iops = MT_TOTAL_OPS / elapsed;
+        if (threads == 1) base = iops;
+        printf("[mt-io] %d thread%s: %9.0f ops/s (x%.2f), gc %llu (bg %llu), mismatches %d\n",
+               threads, threads > 1 ? "s" : " ", iops, iops / base,
+               (unsigned long long)st.gc_count, (unsigned long long)st.bg_gc_count, bad);
+    }
+    free(seq);
+}
+
+// ---------------------------------------------------------------
+// read-lat: writer thread + background GC가 도는 동안 reader 한 thread의 ftl_read() wall-clock latency
+// ---------------------------------------------------------------
+#define RL_READS        200000
+#define RL_WRITERS      2
+
+static int rl_stop;
+
+static void *rl_writer(void *p) {
+    uint8_t buf[NAND_PAGE_SIZE];
+    unsigned seed = 500 + (unsigned)(long)p;
+    memset(buf, 0x5A, NAND_PAGE_SIZE);
+    while (!__atomic_load_n(&rl_stop, __ATOMIC_RELAXED)) {
+        ftl_write(rand_r(&seed) % MT_SPAN, buf);
+    }
+    return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void bench_read_lat(void) {
+    nand_config_t cfg = { .backend = NAND_BACKEND_RAM, .no_timing = 1 };
+    uint64_t *lat = (uint64_t *)malloc(sizeof(uint64_t) * RL_READS);
+    uint8_t buf[NAND_PAGE_SIZE];
+    pthread_t tid[RL_WRITERS];
+    unsigned seed = 9;
+    ftl_stats_t st;
+
+    if (!lat || ftl_init(&cfg) != 0) { printf("[read-lat] init failed\n"); free(lat); return; }
+    memset(buf, 0x5A, NAND_PAGE_SIZE);
+    for (uint32_t lba = 0; lba < MT_SPAN; lba++) ftl_write(lba, buf);
+
+    ftl_bg_gc_start();
+    rl_stop = 0;
+    for (long t = 0; t < RL_WRITERS; t++) pthread_create(&tid[t], NULL, rl_writer, (void *)t);
+    for (int i = 0; i < RL_READS; i++) {
+        struct timespec a, b;
+        clock_gettime(CLOCK_MONOTONIC, &a);
+        ftl_read(rand_r(&seed) % MT_SPAN, buf);
+        clock_gettime(CLOCK_MONOTONIC, &b);
+        lat[i] = (uint64_t)(b.tv_sec - a.tv_sec) * 1000000000ULL + (uint64_t)(b.tv_nsec - a.tv_nsec);
+    }
+    __atomic_store_n(&rl_stop, 1, __ATOMIC_RELAXED);
+    for (int t = 0; t < RL_WRITERS; t++) pthread_join(tid[t], NULL);
+    ftl_get_stats(&st);
+    ftl_exit();
+
+    qsort(lat, RL_READS, sizeof(uint64_t), cmp_u64);
+    printf("[read-lat] %d reads vs %d writers, gc %llu: p50 %llu ns, p99 %llu ns, p99.9 %llu ns, max %llu ns\n",
+           RL_READS, RL_WRITERS, (unsigned long long)st.gc_count,
+           (unsigned long long)lat[RL_READS / 2], (unsigned long long)lat[RL_READS * 99 / 100],
+           (unsigned long long)lat[RL_READS * 999 / 1000], (unsigned long long)lat[RL_READS - 1]);
+    free(lat);
+}
+
+// ---------------------------------------------------------------
+// nvme-qd: NVMe front end에서 queue depth 별 random read / write 처리량 (virtual time)
+// host thread 하나가 queue들에 QD 만큼 명령을 유지하는 closed loop
+// ---------------------------------------------------------------
+#define QD_CMDS         20000
+#define QD_SPAN         (LOGICAL_PAGES_COUNT / 2)
+
+static void qd_run(uint8_t opcode, int nq, int qd) {
+    int per_q = qd / nq;
+    uint8_t *bufs = (uint8_t *)malloc((size_t)qd * NAND_PAGE_SIZE);
+    uint64_t *lat = (uint64_t *)malloc(sizeof(uint64_t) * QD_CMDS);
+    nvme_cqe_t cqes[64];
+    unsigned seed = 42;
+    int submitted = 0, completed = 0;
+    uint64_t t0, t_end = 0;
+
+    if (!bufs || !lat) { free(bufs); free(lat); return; }
+    memset(bufs, 0x3C, (size_t)qd * NAND_PAGE_SIZE);
+    t0 = nand_get_finish_time();
+    nand_wait_until(t0);
+    if (nvme_init(nq, 256) != 0) { printf("[nvme-qd] nvme_init failed\n"); free(bufs); free(lat); return; }
+
+    // cid = buffer 번호, queue q는 q * per_q 부터 per_q 개
+    for (int q = 0; q < nq; q++) {
+        for (int i = 0; i < per_q && submitted < QD_CMDS; i++, submitted++) {
+            nvme_sqe_t cmd = { (uint16_t)(q * per_q + i), opcode, rand_r(&seed) % QD_SPAN, 0,
+                               bufs + (size_t)(q * per_q + i) * NAND_PAGE_SIZE, 0 };
+            nvme_sq_push(q, &cmd);
+        }
+        nvme_sq_ring(q);
+    }
+    while (completed < QD_CMDS) {
+        int reaped = 0;
+        for (int q = 0; q < nq; q++) {
+            int n = nvme_cq_reap(q, cqes, 64);
+            for (int i = 0; i < n; i++) {
+                lat[completed++] = cqes[i].latency_ns;
+                if (cqes[i].done_ns > t_end) t_end = cqes[i].done_ns;
+                if (submitted < QD_CMDS) {
+                    nvme_sqe_t cmd = { cqes[i].cid, opcode, rand_r(&seed) % QD_SPAN, 0,
+                                       bufs + (size_t)cqes[i].cid * NAND_PAGE_SIZE, 0 };
+                    nvme_sq_push(q, &cmd);
+                    submitted++;
+                }
+            }
+            if (n) nvme_sq_ring(q);
+            reaped += n;
+        }
+        if (!reaped) sched_yield();
+    }
+    nvme_exit();
+
+    qsort(lat, QD_CMDS, sizeof(uint64_t), cmp_u64);
+    uint64_t sum = 0;
+    for (int i = 0; i < QD_CMDS; i++) sum += lat[i];
+    double elapsed = (t_end - t0) / 1e9;
+    printf("[nvme-qd] %-5s %dq QD%-4d %9.0f IOPS, latency us: avg %.1f p99 %.1f\n",
+           opcode == NVME_CMD_READ ? "read" : "write", nq, qd, elapsed > 0 ? QD_CMDS / elapsed : 0.0,
+           sum / 1e3 / QD_CMDS, lat[QD_CMDS * 99 / 100] / 1e3);
+    free(bufs);
+    free(lat);
+}
+
+static void bench_nvme_qd(void) {
+    static const int qds[] = { 1, 4, 16, 64, 128 };
+    nand_config_t cfg = { .backend = NAND_BACKEND_SPARSE };
+
+    if (ftl_init(&cfg) != 0) { printf("[nvme-qd] ftl_init failed\n"); return; }
+    uint8_t buf[NAND_PAGE_SIZE * 16];
+    memset(buf, 0x3C, sizeof(buf));
+    for (uint32_t lba = 0; lba < QD_SPAN; lba += 16) ftl_write_multi(lba, 16, buf);
+
+    for (int nq = 1; nq <= 4; nq *= 4) {
+        for (unsigned i = 0; i < sizeof(qds) / sizeof(qds[0]); i++) {
+            if (qds[i] < nq) continue;
+            qd_run(NVME_CMD_READ, nq, qds[i]);
+        }
+    }
+    for (unsigned i = 0; i < sizeof(qds) / sizeof(qds[0]); i++) qd_run(NVME_CMD_WRITE, 1, qds[i]);
+    ftl_exit();
+}
+
+// ---------------------------------------------------------------
+// async-qd: host thread 하나가 async API로 QD 만큼 요청을 유지할 때 IOPS (wall-clock)
+// wait  = 가장 오래된 요청을 ftl_req_wait 후 다시 submit
+// cb    = completion callback에서 다음 요청을 submit
+// ---------------------------------------------------------------
+#define AQ_OPS          200000
+#define AQ_WORKERS      4
+#define ASYNC_MAX_QD    128
+
+typedef struct {
+    int op;
+    int issued;         // atomic
+    int completed;      // atomic
+} aq_ctx_t;
+
+// callback 모드에서 QD slot 하나 = 연속해서 재사용되는 buffer
+typedef struct {
+    aq_ctx_t *ctx;
+    uint8_t *buf;
+    unsigned seed;
+} aq_slot_t;
+
+static ftl_req_t *aq_submit(int op, uint32_t lba, uint8_t *buf, ftl_req_cb_t cb, void *arg) {
+    ftl_req_t *req;
+    // pool이 잠깐 비어 있으면 (callback 해제 직전) 다시 시도
+    while (!(req = op == FTL_OP_READ ? ftl_submit_read(lba, buf, cb, arg)
+                                     : ftl_submit_write(lba, buf, cb, arg))) sched_yield();
+    return req;
+}
+
+static void aq_callback(ftl_req_t *req, int status, void *arg) {
+    aq_slot_t *s = (aq_slot_t *)arg;
+    aq_ctx_t *c = s->ctx;
+    (void)req; (void)status;
+    if (__atomic_fetch_add(&c->issued, 1, __ATOMIC_RELAXED) < AQ_OPS) {
+        aq_submit(c->op, rand_r(&s->seed) % QD_SPAN, s->buf, aq_callback, s);
+    }
+    __atomic_fetch_add(&c->completed, 1, __ATOMIC_RELEASE);
+}
+
+static double aq_run_wait(int op, int qd, uint8_t *bufs) {
+    ftl_req_t **ring = (ftl_req_t **)malloc(sizeof(ftl_req_t *) * qd);
+    unsigned seed = 7;
+    double t0 = now_sec();
+
+    for (int i = 0; i < qd; i++) ring[i] = aq_submit(op, rand_r(&seed) % QD_SPAN, bufs + (size_t)i * NAND_PAGE_SIZE, NULL, NULL);
+    for (int i = qd; i < AQ_OPS + qd; i++) {
+        int slot = i % qd;
+        ftl_req_wait(ring[slot]);
+        ftl_req_release(ring[slot]);
+        if (i < AQ_OPS) ring[slot] = aq_submit(op, rand_r(&seed) % QD_SPAN, bufs + (size_t)slot * NAND_PAGE_SIZE, NULL, NULL);
+    }
+    double elapsed = now_sec() - t0;
+    free(ring);
+    return AQ_OPS / elapsed;
+}
+
+static double aq_run_callback(int op, int qd, uint8_t *bufs) {
+    aq_ctx_t c = { op, qd, 0 };
+    aq_slot_t slots[ASYNC_MAX_QD];
+    double t0 = now_sec();
+
+    for (int i = 0; i < qd; i++) {
+        slots[i] = (aq_slot_t){ &c, bufs + (size_t)i * NAND_PAGE_SIZE, 11u + i };
+        aq_submit(op, rand_r(&slots[i].seed) % QD_SPAN, slots[i].buf, aq_callback, &slots[i]);
+    }
+    while (__atomic_load_n(&c.completed, __ATOMIC_ACQUIRE) < AQ_OPS) sched_yield();
+    return AQ_OPS / (now_sec() - t0);
+}
+
+static void bench_async_qd(void) {
+    static const int qds[] = { 1, 32, ASYNC_MAX_QD };
+    nand_config_t cfg = { .backend = NAND_BACKEND_RAM, .no_timing = 1 };
+    uint8_t *bufs = (uint8_t *)malloc((size_t)ASYNC_MAX_QD * NAND_PAGE_SIZE);
+
+    if (!bufs || ftl_init(&cfg) != 0) { printf("[async-qd] init failed\n"); free(bufs); return; }
+    memset(bufs, 0x6B, (size_t)ASYNC_MAX_QD * NAND_PAGE_SIZE);
+    for (uint32_t lba = 0; lba < QD_SPAN; lba += 16) ftl_write_multi(lba, 16, bufs);
+    // callback이 다음 요청을 걸기 전에 자기 handle이 해제되므로 QD + worker 수 만큼 있으면 충분
+    if (ftl_async_init(AQ_WORKERS, ASYNC_MAX_QD + AQ_WORKERS) != 0) { printf("[async-qd] async init failed\n"); ftl_exit(); free(bufs); return; }
+
+    double sync_iops[2];
+    for (int op = 0; op < 2; op++) {
+        double t0 = now_sec();
+        unsigned seed = 7;
+        for (int i = 0; i < AQ_OPS; i++) {
+            if (op == FTL_OP_READ) ftl_read(rand_r(&seed) % QD_SPAN, bufs);
+            else ftl_write(rand_r(&seed) % QD_SPAN, bufs);
+        }
+        sync_iops[op] = AQ_OPS / (now_sec() - t0);
+    }
+    printf("[async-qd] %d workers, %d ops; sync ftl_read %.0f IOPS, ftl_write %.0f IOPS\n",
+           AQ_WORKERS, AQ_OPS, sync_iops[FTL_OP_READ], sync_iops[FTL_OP_WRITE]);
+    for (unsigned i = 0; i < sizeof(qds) / sizeof(qds[0]); i++) {
+        for (int op = 0; op < 2; op++) {
+            double w = aq_run_wait(op, qds[i], bufs);
+            double cb = aq_run_callback(op, qds[i], bufs);
+            printf("[async-qd] %-5s QD%-4d wait %9.0f IOPS, callback %9.0f IOPS\n",
+                   op == FTL_OP_READ ? "read" : "write", qds[i], w, cb);
+        }
+    }
+    ftl_async_exit();
+    ftl_exit();
+    free(bufs);
+}
+
+// ---------------------------------------------------------------
+// read-cache: Zipf read 부하에서 read cache 크기 별 적중률 / latency (DRAM sizing)
+// ---------------------------------------------------------------
+#define RC_SPAN         32768
+#define RC_READS        200000
+#define ZIPF_THETA      0.99
+
+// rank 0이 가장 자주 나오는 Zipf 분포 CDF
+static double *zipf_cdf(int n, double theta) {
+    double *cdf = (double *)malloc(sizeof(double) * n);
+    double sum = 0;
+    if (!cdf) return NULL;
+    for (int i = 0; i < n; i++) sum += 1.0 / pow(i + 1, theta);
+    double acc = 0;
+    for (int i = 0; i < n; i++) {
+        acc += 1.0 / pow(i + 1, theta) / sum;
+        cdf[i] = acc;
+    }
+    return cdf;
+}
+
+static int zipf_next(const double *cdf, int n, unsigned *seed) {
+    double u = (double)rand_r(seed) / RAND_MAX;
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (cdf[mid] < u) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static void bench_read_cache(void) {
+    static const int sizes[] = { 0, 512, 2048, 8192 };
+    nand_config_t cfg = { .backend = NAND_BACKEND_SPARSE };
+    double *cdf = zipf_cdf(RC_SPAN, ZIPF_THETA);
+    if (!cdf) return;
+
+    printf("[read-cache] %d Zipf(%.2f) reads over %d pages\n", RC_READS, ZIPF_THETA, RC_SPAN);
+    for (unsigned i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        unsigned seed = 3;
+        ftl_stats_t st;
+
+        if (ftl_init(&cfg) != 0) break;
+        uint8_t buf[16 * NAND_PAGE_SIZE];
+        memset(buf, 0x11, sizeof(buf));
+        for (uint32_t lba = 0; lba < RC_SPAN; lba += 16) ftl_write_multi(lba, 16, buf);
+        ftl_set_read_cache(sizes[i]);
+        nand_wait_until(nand_get_finish_time());
+
+        uint64_t v0 = nand_get_time();
+        double t0 = now_sec();
+        for (int r = 0; r < RC_READS; r++) {
+            // hot rank를 LBA 공간 (여러 die)에 흩어 놓음
+            uint32_t lba = (uint32_t)(((uint64_t)zipf_next(cdf, RC_SPAN, &seed) * 7919) % RC_SPAN);
+            ftl_read(lba, buf);
+        }
+        double wall = now_sec() - t0;
+        uint64_t virt = nand_get_time() - v0;
+        ftl_get_stats(&st);
+        ftl_exit();
+
+        uint64_t lookups = st.rc_hits + st.rc_misses;
+        printf("[read-cache] %5d pages (%5.1f MB): hit %5.1f%%, avg read %6.1f us virtual, %5.0f ns wall\n",
+               sizes[i], sizes[i] * (double)NAND_PAGE_SIZE / (1 << 20),
+               lookups ? 100.0 * st.rc_hits / lookups : 0.0,
+               virt / 1e3 / RC_READS, wall * 1e9 / RC_READS);
+    }
+    free(cdf);
+}
+
+// ---------------------------------------------------------------
+// dftl: CMT 크기 별 적중률 / translation page I/O / latency와 mapping DRAM (DRAM sizing)
+// ---------------------------------------------------------------
+#define DFTL_SPAN       32768
+#define DFTL_OPS        100000
+
+static void bench_dftl(void) {
+    static const int sizes[] = { 0, 512, 2048, 8192 };    // 0 = flat L2P
+    nand_config_t cfg = { .backend = NAND_BACKEND_SPARSE };
+    double *cdf = zipf_cdf(DFTL_SPAN, ZIPF_THETA);
+    if (!cdf) return;
+
+    printf("[dftl] %d ops (70%% read) over %d pages after sequential fill\n", DFTL_OPS, DFTL_SPAN);
+    for (int zipf = 1; zipf >= 0; zipf--) {
+        for (unsigned i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            unsigned seed = 5;
+            ftl_stats_t st0, st;
+
+            if (ftl_init(&cfg) != 0) break;
+            if (ftl_set_map_cache(sizes[i]) != 0) { ftl_exit(); break; }
+            uint8_t buf[16 * NAND_PAGE_SIZE];
+            memset(buf, 0x22, sizeof(buf));
+            for (uint32_t lba = 0; lba < DFTL_SPAN; lba += 16) ftl_write_multi(lba, 16, buf);
+            nand_wait_until(nand_get_finish_time());
+            ftl_get_stats(&st0);
+
+            uint64_t v0 = nand_get_time();
+            for (int op = 0; op < DFTL_OPS; op++) {
+                uint32_t lba = zipf ? (uint32_t)(((uint64_t)zipf_next(cdf, DFTL_SPAN, &seed) * 7919) % DFTL_SPAN)
+                                    : (uint32_t)rand_r(&seed) % DFTL_SPAN;
+                if (rand_r(&seed) % 10 < 7) ftl_read(lba, buf);
+                else ftl_write(lba, buf);
+            }
+            uint64_t virt = nand_get_time() - v0;
+            ftl_get_stats(&st);
+            ftl_exit();
+
+            uint64_t hits = st.cmt_hits - st0.cmt_hits, misses = st.cmt_misses - st0.cmt_misses;
+            char name[16], hit[16];
+            snprintf(name, sizeof(name), sizes[i] ? "%d" : "flat", sizes[i]);
+            if (sizes[i]) snprintf(hit, sizeof(hit), "%5.1f%%", 100.0 * hits / (hits + misses));
+            else snprintf(hit, sizeof(hit), "     -");
+            printf("[dftl] %-7s %4s: map %6.1f KB, CMT hit %s, per 1k ops: %6.1f map reads %5.1f map writes, avg op %6.1f us virtual\n",
+                   zipf ? "zipf" : "uniform", name, st.map_dram_bytes / 1024.0, hit,
+                   1000.0 * (st.map_reads - st0.map_reads) / DFTL_OPS,
+                   1000.0 * (st.map_writes - st0.map_writes) / DFTL_OPS,
+                   virt / 1e3 / DFTL_OPS);
+        }
+    }
+    free(cdf);
+}
+
+// ---------------------------------------------------------------
+// extent-map: fill 패턴 별 mapping 메모리와 read latency (flat vs extent L2P)
+// ---------------------------------------------------------------
+#define EXT_SPAN        LOGICAL_PAGES_COUNT
+#define EXT_READS       200000
+
+static void bench_extent_map(void) {
+    static const char *fills[] = { "sequential", "seq+1% rand", "seq+10% rand", "random" };
+    nand_config_t cfg = { .backend = NAND_BACKEND_SPARSE, .no_timing = 1 };
+
+    printf("[extent-map] %u pages, flat vs extent L2P (lookup = ftl_read incl. 4KB copy, no timing)\n", EXT_SPAN);
+    for (int fill = 0; fill < 4; fill++) {
+        for (int ext = 0; ext <= 1; ext++) {
+            unsigned seed = 9;
+            ftl_stats_t st;
+
+            if (ftl_init(&cfg) != 0) return;
+            if (ext && ftl_set_extent_map(1) != 0) { ftl_exit(); return; }
+            uint8_t buf[PAGES_PER_BLOCK * NAND_PAGE_SIZE];
+            memset(buf, 0x33, sizeof(buf));
+            if (fill < 3) {
+                for (uint32_t lba = 0; lba < EXT_SPAN; lba += PAGES_PER_BLOCK) {
+                    ftl_write_multi(lba, EXT_SPAN - lba < (uint32_t)PAGES_PER_BLOCK ? (int)(EXT_SPAN - lba) : PAGES_PER_BLOCK, buf);
+                }
+                int overwrite = fill ? EXT_SPAN / (fill == 1 ? 100 : 10) : 0;
+                for (int i = 0; i < overwrite; i++) ftl_write((uint32_t)rand_r(&seed) % EXT_SPAN, buf);
+            } else {
+                uint32_t *order = (uint32_t *)malloc(sizeof(uint32_t) * EXT_SPAN);
+                if (!order) { ftl_exit(); return; }
+                for (uint32_t i = 0; i < EXT_SPAN; i++) order[i] = i;
+                for (uint32_t i = EXT_SPAN - 1; i > 0; i--) {
+                    uint32_t j = (uint32_t)rand_r(&seed) % (i + 1), t = order[i];
+                    order[i] = order[j];
+                    order[j] = t;
+                }
+                for (uint32_t i = 0; i < EXT_SPAN; i++) ftl_write(order[i], buf);
+                free(order);
+            }
+            ftl_get_stats(&st);
+
+            double t0 = now_sec();
+            for (int r = 0; r < EXT_READS; r++) ftl_read((uint32_t)rand_r(&seed) % EXT_SPAN, buf);
+            double rnd = (now_sec() - t0) * 1e9 / EXT_READS;
+            t0 = now_sec();
+            for (int r = 0; r < EXT_READS; r++) ftl_read((uint32_t)r % EXT_SPAN, buf);
+            double seq = (now_sec() - t0) * 1e9 / EXT_READS;
+            ftl_exit();
+
+            // 전체 LBA를 채웠으므로 page 당 byte = 용량 대비, 4KB page 기준 1TB = 2^28 page
+            double per_page = (double)st.map_dram_bytes / EXT_SPAN;
+            printf("[extent-map] %-12s %-6s: map %7.1f KB, %5.2f B/page (%6.0f MB per TB), read %4.0f ns random %4.0f ns sequential\n",
+                   fills[fill], ext ? "extent" : "flat", st.map_dram_bytes / 1024.0, per_page,
+                   per_page * (1ULL << 28) / (1 << 20), rnd, seq);
+        }
+    }
+}
+
+// ---------------------------------------------------------------
+// geometry: page / block 크기와 over-provisioning 별 random overwrite WAF와 처리량
+// pages/block 96은 2의 거듭제곱이 아니라 PPA 분해가 나눗셈으로 감
+// ---------------------------------------------------------------
+#define GEO_OVERWRITE   2       // 순차 fill 후 logical 용량의 이 배수만큼 random overwrite
+
+static void bench_geometry(void) {
+    static const struct {
+        const char *name;
+        nand_geometry_t geo;
+    } geos[] = {
+        { "4K/64/1024 (default)", { 0 } },
+        { "4K/96/688", { .pages_per_block = 96, .blocks = 688 } },
+        { "16K/128/512", { .page_size = 16384, .oob_size = 512, .pages_per_block = 128, .blocks = 512 } },
+        { "2K/128/1024", { .page_size = 2048, .oob_size = 64, .pages_per_block = 128, .blocks = 1024 } },
+    };
+    static const uint32_t ops[] = { 7, 0, 14, 28 };     // 0 = 기본 비율 (약 9.2%)
+
+    printf("[geometry] sequential fill + %dx random overwrite (timing on)\n", GEO_OVERWRITE);
+    for (unsigned g = 0; g < sizeof(geos) / sizeof(geos[0]); g++) {
+        for (unsigned o = 0; o < sizeof(ops) / sizeof(ops[0]); o++) {
+            nand_config_t cfg = { .backend = NAND_BACKEND_SPARSE, .geometry = geos[g].geo };
+            unsigned seed = 13;
+            ftl_stats_t st0, st;
+
+            cfg.geometry.op_percent = ops[o];
+            if (ftl_init(&cfg) != 0) {
+                printf("[geometry] %-20s op_percent %2u: unsupported\n", geos[g].name, ops[o]);
+                continue;
+            }
+            uint8_t *buf = (uint8_t *)malloc((size_t)PAGES_PER_BLOCK * NAND_PAGE_SIZE);
+            if (!buf) { ftl_exit(); return; }
+            memset(buf, 0x44, (size_t)PAGES_PER_BLOCK * NAND_PAGE_SIZE);
+            int logical = LOGICAL_PAGES_COUNT, writes = GEO_OVERWRITE * logical;
+            for (int lba = 0; lba < logical; lba += PAGES_PER_BLOCK) {
+                ftl_write_multi(lba, logical - lba < PAGES_PER_BLOCK ? logical - lba : PAGES_PER_BLOCK, buf);
+            }
+            ftl_get_stats(&st0);
+
+            uint64_t v0 = nand_get_time();
+            double t0 = now_sec();
+            for (int i = 0; i < writes; i++) ftl_write((uint32_t)rand_r(&seed) % logical, buf);
+            double wall = now_sec() - t0;
+            double virt = (nand_get_finish_time() - v0) / 1e9;
+            ftl_get_stats(&st);
+            int page = NAND_PAGE_SIZE;
+            double op = 100.0 * ((double)BLOCKS_PER_CHIP * PAGES_PER_BLOCK - logical) / logical;
+            ftl_exit();
+            free(buf);
+
+            uint64_t host = st.host_pages - st0.host_pages;
+            uint64_t programs = st.nand_pages - st0.nand_pages + st.gc_pages - st0.gc_pages;
+            printf("[geometry] %-20s OP %4.1f%%: %6d logical pages, WAF %5.2f, %6.1f MB/s virtual, %5.0f ns/write wall\n",
+                   geos[g].name, op, logical, (double)programs / host,
+                   virt > 0 ? host * (double)page / virt / (1 << 20) : 0.0, wall * 1e9 / writes);
+        }
+    }
+}
+
+// ---------------------------------------------------------------
+// trim: filesystem 형태 부하 (file 생성 / 삭제 + 살아 있는 file의 page 덮어쓰기)
+// device를 한 번 다 채운 뒤 file을 지워 live 비율까지 줄이고 steady state를 측정
+// 삭제를 ftl_trim으로 알리지 않으면 FTL은 지운 file도 valid로 보고 GC가 계속 옮김
+// ---------------------------------------------------------------
+#define TRIM_FILE_PAGES 16      // file 하나 = 연속 LBA 16 page
+#define TRIM_WRITES     3       // steady state host write = logical 용량의 이 배수
+#define TRIM_CHURN      3       // 10번 중 이만큼은 file 하나 삭제 + 새 file 생성, 나머지는 1 page 덮어쓰기
+
+static void bench_trim(void) {
+    static const int lives[] = { 50, 75 };     // live file이 차지하는 logical 용량 %
+    nand_config_t cfg = { .backend = NAND_BACKEND_SPARSE, .no_timing = 1 };
+
+    printf("[trim] %d-page files, %d%% create/delete + 1-page overwrites, %dx logical capacity written\n",
+           TRIM_FILE_PAGES, TRIM_CHURN * 10, TRIM_WRITES);
+    for (unsigned l = 0; l < sizeof(lives) / sizeof(lives[0]); l++) {
+        for (int trim = 0; trim <= 1; trim++) {
+            unsigned seed = 17;
+            ftl_stats_t st0, st;
+
+            if (ftl_init(&cfg) != 0) return;
+            // files[0..nfiles) = live file의 slot, files[nfiles..slots) = 빈 slot
+            int slots = LOGICAL_PAGES_COUNT / TRIM_FILE_PAGES, nfiles = slots;
+            int *files = (int *)malloc(sizeof(int) * slots);
+            uint8_t *buf = (uint8_t *)malloc((size_t)TRIM_FILE_PAGES * NAND_PAGE_SIZE);
+            if (!files || !buf) { free(files); free(buf); ftl_exit(); return; }
+            memset(buf, 0x55, (size_t)TRIM_FILE_PAGES * NAND_PAGE_SIZE);
+
+            // aging: 전체를 채우고 live 비율까지 지움
+            for (int i = 0; i < slots; i++) {
+                files[i] = i;
+                ftl_write_multi((uint32_t)i * TRIM_FILE_PAGES, TRIM_FILE_PAGES, buf);
+            }
+            while (nfiles > slots * lives[l] / 100) {
+                int i = rand_r(&seed) % nfiles, f = files[i];
+                files[i] = files[--nfiles];
+                files[nfiles] = f;
+                if (trim) ftl_trim((uint32_t)f * TRIM_FILE_PAGES, TRIM_FILE_PAGES);
+            }
+            ftl_get_stats(&st0);
+
+            uint64_t target = (uint64_t)TRIM_WRITES * LOGICAL_PAGES_COUNT;
+            for (uint64_t written = 0; written < target; ) {
+                if (rand_r(&seed) % 10 < TRIM_CHURN) {
+                    // live file 하나 삭제, 빈 slot 하나에 새 file
+                    int i = rand_r(&seed) % nfiles, f = files[i];
+                    files[i] = files[--nfiles];
+                    files[nfiles] = f;
+                    if (trim) ftl_trim((uint32_t)f * TRIM_FILE_PAGES, TRIM_FILE_PAGES);
+                    int j = nfiles + rand_r(&seed) % (slots - nfiles);
+                    f = files[j];
+                    files[j] = files[nfiles];
+                    files[nfiles++] = f;
+                    ftl_write_multi((uint32_t)f * TRIM_FILE_PAGES, TRIM_FILE_PAGES, buf);
+                    written += TRIM_FILE_PAGES;
+                } else {
+                    int f = files[rand_r(&seed) % nfiles];
+                    ftl_write((uint32_t)f * TRIM_FILE_PAGES + rand_r(&seed) % TRIM_FILE_PAGES, buf);
+                    written++;
+                }
+            }
+            ftl_get_stats(&st);
+            ftl_exit();
+            free(files);
+            free(buf);
+
+            uint64_t host = st.host_pages - st0.host_pages, copied = st.gc_pages - st0.gc_pages;
+            printf("[trim] live %d%% trim %-3s: WAF %5.2f, copy-back %8llu pages (%.2f per host page), trimmed %llu pages\n",
+                   lives[l], trim ? "on" : "off", (double)(st.nand_pages - st0.nand_pages + copied) / host,
+                   (unsigned long long)copied, (double)copied / host, (unsigned long long)st.trim_pages);
+        }
+    }
+}
+
+// ---------------------------------------------------------------
+// gc-cpu: victim block 하나를 회수하는 데 드는 simulator CPU 시간 (no timing)
+// total = GC 전체, ftl = copy-back / erase HAL 호출을 뺀 부분 (victim 선택, valid page 찾기, mapping 갱신)
+// sequential = 순서대로 덮어씀 (victim 전부 invalid), hot = 10% 구간만 random, uniform = 전체 random
+// ---------------------------------------------------------------
+#define GC_CPU_WRITES   2       // fill 후 logical 용량의 이 배수만큼 random overwrite
+
+static void bench_gc_cpu(void) {
+    static const struct { const char *name; int span_pct; } loads[] = {
+        { "sequential", 0 }, { "hot 10%", 10 }, { "uniform", 100 },
+    };
+    nand_config_t cfg = { .backend = NAND_BACKEND_SPARSE, .no_timing = 1 };
+
+    for (unsigned w = 0; w < sizeof(loads) / sizeof(loads[0]); w++) {
+        unsigned seed = 21;
+        ftl_stats_t st0, st;
+
+        if (ftl_init(&cfg) != 0) return;
+        uint8_t *buf = (uint8_t *)malloc((size_t)PAGES_PER_BLOCK * NAND_PAGE_SIZE);
+        if (!buf) { ftl_exit(); return; }
+        memset(buf, 0x66, (size_t)PAGES_PER_BLOCK * NAND_PAGE_SIZE);
+        int logical = LOGICAL_PAGES_COUNT, span = logical / 100 * loads[w].span_pct;
+        for (int lba = 0; lba < logical; lba += PAGES_PER_BLOCK) {
+            ftl_write_multi(lba, logical - lba < PAGES_PER_BLOCK ? logical - lba : PAGES_PER_BLOCK, buf);
+        }
+        ftl_get_stats(&st0);
+        for (int i = 0; i < GC_CPU_WRITES * logical; i++) {
+            ftl_write(span ? (uint32_t)rand_r(&seed) % span : (uint32_t)(i % logical), buf);
+        }
+        ftl_get_stats(&st);
+        int ppb = PAGES_PER_BLOCK;
+        ftl_exit();
+        free(buf);
+
+        uint64_t victims = st.gc_count - st0.gc_count, copied = st.gc_pages - st0.gc_pages;
+        if (!victims) continue;
+        uint64_t total = st.gc_ns - st0.gc_ns, ftl = total - (st.gc_nand_ns - st0.gc_nand_ns);
+        printf("[gc-cpu] %-10s: %6llu victims, %5.1f of %d pages valid, GC us per victim: total %6.2f, ftl %5.2f\n",
+               loads[w].name, (unsigned long long)victims, (double)copied / victims, ppb,
+               total / 1e3 / victims, ftl / 1e3 / victims);
+    }
+}
+
+// ---------------------------------------------------------------
+// gc-policy: GC victim 정책 별 WAF (no timing)
+// 전체를 순서대로 채우고 logical 용량만큼 warm-up 한 뒤 GC_POLICY_WRITES 배만큼 측정
+// uniform = 전체 random, zipf = Zipf(ZIPF_THETA) (rank를 흩뿌림), hot/cold = write 80%가 LBA 20%로
+// ---------------------------------------------------------------
+#define GC_POLICY_WRITES    3
+
+static void bench_gc_policy(void) {
+    static const char *traces[] = { "uniform", "zipf", "hot/cold" };
+    static const char *names[FTL_GC_POLICY_COUNT] = { "greedy", "cost-benefit", "d-choices", "windowed" };
+    nand_config_t cfg = { .backend = NAND_BACKEND_SPARSE, .no_timing = 1 };
+
+    for (int t = 0; t < 3; t++) {
+        for (int p = 0; p < FTL_GC_POLICY_COUNT; p++) {
+            unsigned seed = 23;
+            ftl_stats_t st0, st;
+
+            if (ftl_init(&cfg) != 0) return;
+            int logical = LOGICAL_PAGES_COUNT, hot = logical / 5;
+            double *cdf = t == 1 ? zipf_cdf(logical, ZIPF_THETA) : NULL;
+            uint8_t *buf = (uint8_t *)malloc((size_t)PAGES_PER_BLOCK * NAND_PAGE_SIZE);
+            if (!buf || (t == 1 && !cdf)) { free(cdf); free(buf); ftl_exit(); return; }
+            memset(buf, 0x77, (size_t)PAGES_PER_BLOCK * NAND_PAGE_SIZE);
+            ftl_set_gc_policy((ftl_gc_policy_t)p, 0);
+
+            for (int lba = 0; lba < logical; lba += PAGES_PER_BLOCK) {
+                ftl_write_multi(lba, logical - lba < PAGES_PER_BLOCK ? logical - lba : PAGES_PER_BLOCK, buf);
+            }
+            for (int i = 0; i < (1 + GC_POLICY_WRITES) * logical; i++) {
+                if (i == logical) ftl_get_stats(&st0);
+                uint32_t lba;
+                if (t == 0) lba = (uint32_t)rand_r(&seed) % logical;
+                else if (t == 1) lba = (uint32_t)(((uint64_t)zipf_next(cdf, logical, &seed) * 7919) % logical);
+                else if (rand_r(&seed) % 10 < 8) lba = (uint32_t)rand_r(&seed) % hot;
+                else lba = hot + (uint32_t)rand_r(&seed) % (logical - hot);
+                ftl_write(lba, buf);
+            }
+            ftl_get_stats(&st);
+            ftl_exit();
+            free(cdf);
+            free(buf);
+
+            uint64_t host = st.host_pages - st0.host_pages, copied = st.gc_pages - st0.gc_pages;
+            printf("[gc-policy] %-8s %-12s: WAF %5.2f, copy-back %8llu pages, %6llu victims\n",
+                   traces[t], names[p], (double)(st.nand_pages - st0.nand_pages + copied) / host,
+                   (unsigned long long)copied, (unsigned long long)(st.gc_count - st0.gc_count));
+        }
+    }
+}
+
+// ---------------------------------------------------------------
+// streams: hot / cold 분리 별 WAF (no timing, greedy), 기본 OP와 OP 28%
+// single = stream 하나, auto = ftl_set_hot_cold 분류, hint = workload가 아는 hot 구간을 stream hint로
+// 전체를 채우고 logical 용량만큼 warm-up 한 뒤 STREAM_WRITES 배만큼 측정
+// ---------------------------------------------------------------
+#define STREAM_WRITES   3
+
+static void bench_streams(void) {
+    static const struct { const char *name; int hot_pct, write_pct; } loads[] = {
+        { "80/20", 20, 80 }, { "95/5", 5, 95 }, { "zipf", 10, 0 },     // zipf: hint는 rank 상위 10%
+    };
+    static const char *modes[] = { "single", "auto", "hint" };
+    static const int ops[] = { 0, 28 };
+    nand_config_t cfg = { .backend = NAND_BACKEND_SPARSE, .no_timing = 1 };
+
+    for (int o = 0; o < 2; o++) {
+        for (unsigned w = 0; w < sizeof(loads) / sizeof(loads[0]); w++) {
+            for (int mode = 0; mode < 3; mode++) {
+                unsigned seed = 29;
+                ftl_stats_t st0, st;
+
+                cfg.geometry.op_percent = (uint32_t)ops[o];
+                if (ftl_init(&cfg) != 0) return;
+                int logical = LOGICAL_PAGES_COUNT, hot = logical / 100 * loads[w].hot_pct;
+                double *cdf = loads[w].write_pct ? NULL : zipf_cdf(logical, ZIPF_THETA);
+                uint8_t *buf = (uint8_t *)malloc((size_t)PAGES_PER_BLOCK * NAND_PAGE_SIZE);
+                if (!buf || (!loads[w].write_pct && !cdf)) { free(cdf); free(buf); ftl_exit(); return; }
+                memset(buf, 0x44, (size_t)PAGES_PER_BLOCK * NAND_PAGE_SIZE);
+                if (mode == 1) ftl_set_hot_cold(1);
+
+                for (int lba = 0; lba < logical; lba += PAGES_PER_BLOCK) {
+                    ftl_write_multi(lba, logical - lba < PAGES_PER_BLOCK ? logical - lba : PAGES_PER_BLOCK, buf);
+                }
+                for (int i = 0; i < (1 + STREAM_WRITES) * logical; i++) {
+                    if (i == logical) ftl_get_stats(&st0);
+                    uint32_t lba;
+                    int is_hot;
+                    if (cdf) {
+                        int rank = zipf_next(cdf, logical, &seed);
+                        lba = (uint32_t)(((uint64_t)rank * 7919) % logical);
+                        is_hot = rank < hot;
+                    } else {
+                        is_hot = rand_r(&seed) % 100 < loads[w].write_pct;
+                        lba = is_hot ? (uint32_t)rand_r(&seed) % hot : hot + (uint32_t)rand_r(&seed) % (logical - hot);
+                    }
+                    if (mode == 2) ftl_write_stream(lba, 1, buf, is_hot ? FTL_STREAM_HOT : FTL_STREAM_COLD);
+                    else ftl_write(lba, buf);
+                }
+                ftl_get_stats(&st);
+                ftl_exit();
+                free(cdf);
+                free(buf);
+
+                uint64_t host = st.host_pages - st0.host_pages, copied = st.gc_pages - st0.gc_pages;
+                printf("[streams] OP %-7s %-5s %-6s: WAF %5.2f, copy-back %8llu pages, %6llu victims\n",
+                       o ? "28%" : "default", loads[w].name, modes[mode],
+                       (double)(st.nand_pages - st0.nand_pages + copied) / host, (unsigned long long)copied, (unsigned long long)(st.gc_count - st0.gc_count));
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------
+// endurance: wear leveling 별 erase 횟수 분포 (no timing, greedy)
+// 전체를 채운 뒤 LBA 앞 ENDURANCE_HOT_PCT%에만 ENDURANCE_WRITES x logical 번 random write
+// 나머지 cold data는 한 번도 안 바뀌므로 그 block들은 wear leveling 없이는 erase 되지 않음
+// fifo = FIFO free pool, dynamic = erase 횟수 순 free pool, static = dynamic + spread ENDURANCE_SPREAD
+// ---------------------------------------------------------------
+#define ENDURANCE_WRITES    30
+#define ENDURANCE_HOT_PCT   10
+#define ENDURANCE_SPREAD    16
+
+static void bench_endurance(void) {
+    static const struct { const char *name; int dynamic, spread; } modes[] = {
+        { "fifo", 0, 0 }, { "dynamic", 1, 0 }, { "static", 1, ENDURANCE_SPREAD },
+    };
+    nand_config_t cfg = { .backend = NAND_BACKEND_SPARSE, .no_timing = 1 };
+
+    for (unsigned m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        unsigned seed = 31;
+        ftl_stats_t st;
+
+        if (ftl_init(&cfg) != 0) return;
+        int logical = LOGICAL_PAGES_COUNT, hot = logical / 100 * ENDURANCE_HOT_PCT;
+        uint8_t *buf = (uint8_t *)malloc((size_t)PAGES_PER_BLOCK * NAND_PAGE_SIZE);
+        if (!buf) { ftl_exit(); return; }
+        memset(buf, 0x55, (size_t)PAGES_PER_BLOCK * NAND_PAGE_SIZE);
+        ftl_set_wear_leveling(modes[m].dynamic, modes[m].spread);
+
+        double t0 = now_sec();
+        for (int lba = 0; lba < logical; lba += PAGES_PER_BLOCK) {
+            ftl_write_multi(lba, logical - lba < PAGES_PER_BLOCK ? logical - lba : PAGES_PER_BLOCK, buf);
+        }
+        for (int i = 0; i < ENDURANCE_WRITES * logical; i++) {
+            ftl_write((uint32_t)rand_r(&seed) % hot, buf);
+        }
+        double sec = now_sec() - t0;
+        ftl_get_stats(&st);
+
+        // erase 횟수는 ftl_exit 전에 (HAL이 내려가면 0)
+        uint32_t min = UINT32_MAX, max = 0;
+        double sum = 0, sq = 0;
+        int good = 0;
+        for (int b = 0; b < BLOCKS_PER_CHIP; b++) {
+            if (nand_is_bad_block(b)) continue;
+            uint32_t e = nand_get_erase_count(b);
+            if (e < min) min = e;
+            if (e > max) max = e;
+            sum += e;
+            sq += (double)e * e;
+            good++;
+        }
+        ftl_exit();
+        free(buf);
+
+        double mean = sum / good;
+        printf("[endurance] %-7s: erase min %5u max %5u mean %7.1f stddev %6.1f, WAF %5.2f, wl %5llu blocks (%.1f s)\n",
+               modes[m].name, min, max, mean, sqrt(sq / good - mean * mean),
+               (double)(st.nand_pages + st.gc_pages) / st.host_pages, (unsigned long long)st.wl_count, sec);
+    }
+}
+
+typedef struct {
+    const char *name;
+    void (*run)(void);
+} bench_t;
+
+static const bench_t benches[] = {
+    { "gc-pick", bench_gc_pick },
+    { "init", bench_init },
+    { "oob-scan", bench_oob_scan },
+    { "mt-io", bench_mt_io },
+    { "read-lat", bench_read_lat },
+    { "nvme-qd", bench_nvme_qd },
+    { "async-qd", bench_async_qd },
+    { "read-cache", bench_read_cache },
+    { "dftl", bench_dftl },
+    { "extent-map", bench_extent_map },
+    { "geometry", bench_geometry },
+    { "trim", bench_trim },
+    { "gc-cpu", bench_gc_cpu },
+    { "gc-policy", bench_gc_policy },
+    { "streams", bench_streams },
+    { "endurance", bench_endurance },
+};
+
+int main(int argc, char **argv) {
+    int ran = 0;
+    for (unsigned i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        if (argc > 1 && strcmp(argv[1], benches[i].name) != 0) continue;
+        benches[i].run();
+        ran++;
+    }
+    if (!ran) {
+        printf("Unknown benchmark: %s\n", argv[1]);
+        return -1;
+    }
+    return 0;
+}
@@ -1,119 +1,1857 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
 #include "nand_hal.h"
 #include "ftl.h"  // 여기서 ftl.h를 부릅니다
+#include "ftl_victim.h"
+#include "ftl_extent.h"
 
 // 내부 함수 선언
-static void ftl_gc(void);
-static int ftl_find_victim_block(void);
-static int ftl_get_free_block(void);
+static int ftl_gc(int die);
+static int ftl_gc_run(int die, int max_pages, int *reclaimed);
+static void ftl_invalidate(uint32_t ppa);
+static int ftl_find_victim_block(int die);
+static int ftl_get_free_block(int die, int for_gc);
+static int ftl_open_block(int die, int stream);
+static int ftl_reserve(int die, int stream, int n, uint32_t *ppa);
+static uint32_t ftl_map(uint32_t lba, uint32_t ppa);
+static void ftl_block_programmed(int block, int n);
+static void ftl_block_close(int block);
+static void rc_invalidate(uint32_t lba);
+static uint32_t l2p_get(uint32_t lba);
+static uint32_t l2p_set(uint32_t lba, uint32_t ppa);
+static void map_lock_acquire(void);
+static void map_lock_release(void);
+static int ftl_alloc_page(int die, int wl, uint32_t *ppa);
+static int ftl_program_run(const uint32_t *lbas, int n, const uint8_t *data, int stream);
+static void free_pool_push(int block);
+static int free_pool_pop(int die);
+static int ftl_mount(void);
 
 typedef struct {
     int invalid_page_count;
     int is_free;
+    int programmed;             // program 끝난 host page 수 (atomic), 다 차면 GC 후보
+    uint64_t mtime;             // 마지막으로 바뀐 시각: 닫힘 또는 page invalidate (gc_now, die lock)
+    uint32_t free_seq;          // free pool에 들어온 순서 (같은 erase 횟수끼리는 FIFO)
 } block_info_t;
 
-static uint32_t *l2p_table = NULL;
+// die 당 GC 전용 예약 free block 수 (over-provisioning)
+// host는 이 아래로 free block을 가져갈 수 없으므로 GC는 항상 목적지 block을 확보할 수 있음
+#define GC_RESERVED_BLOCKS  2
+#define GC_HIGH_WATERMARK   8   // background GC는 die의 free block이 이만큼 될 때까지 진행
+#define BG_GC_STEP_PAGES    4   // ftl_idle()에서 한 번에 copy-back 하는 page 수
+#define GC_D_CHOICES        8   // d-choices 기본 표본 수
+#define GC_WINDOW           16  // windowed greedy 기본 창 크기 (block)
+#define GC_CB_CANDIDATES    16  // cost-benefit 기본 후보 수 (invalid 많은 쪽 + 오래된 쪽 각각)
+#define WL_INTERVAL         8   // static wear leveling은 die의 GC erase 이만큼마다 한 번 검사
+
+// host open block cursor: 상위 32bit = block, 하위 32bit = 다음 page
+// writer는 fetch-add 한 번으로 lock 없이 page를 예약함
+#define CURSOR(block, page)     (((uint64_t)(uint32_t)(block) << 32) | (uint32_t)(page))
+#define CURSOR_BLOCK(c)         ((int)((c) >> 32))
+#define CURSOR_PAGE(c)          ((uint32_t)(c))
+
+// die 마다 독립된 log: open block / free pool / victim index
+// host write와 GC copy-back은 서로 다른 open block에 씀 (hot / cold 분리)
+//
+// 동시성 (die 단위):
+//  - lock       : free pool, victim index, GC 상태, block 교체, 이 die를 가리키던 L2P entry의 변경
+//  - cursor     : host page 예약은 lock 없이 atomic
+// host open block은 write stream 마다 하나 (처음 쓸 때 엶)
+typedef struct {
+    uint64_t cursor[FTL_STREAMS];   // stream 별 host write (atomic)
+    int gc_block;               // GC copy-back destination
+    int gc_page;
+    int wl_block;               // static wear leveling이 옮기는 cold data의 destination
+    int wl_page;
+    int gc_victim;              // incremental GC 진행 중인 victim (-1 = 없음)
+    int gc_scan;                // victim에서 다음에 볼 page
+    int *free_pool;             // min-heap (free_key): erase 횟수가 적은 block부터 꺼냄
+    int free_count;
+    uint32_t free_seq;          // 다음 push의 순번
+    uint32_t max_erase;         // die에서 가장 많이 erase 된 block의 횟수
+    int wl_skip;                // 다음 static wear leveling 검사까지 남은 GC erase 수
+    int gc_wl;                  // 현재 (또는 마지막) victim이 wear leveling으로 고른 block
+    int gc_bad;                 // 현재 (또는 마지막) victim이 bad block: erase 후 free pool에 넣지 않음
+    victim_index_t victim_idx;  // closed block -> invalid count bucket
+    unsigned gc_seed;           // d-choices 표본 추출 (die lock)
+    int map_block;              // DFTL translation page block
+    int map_page;
+    pthread_mutex_t lock;
+} die_info_t;
+
+uint32_t ftl_logical_pages = DEFAULT_LOGICAL_PAGES;
+
+static uint32_t *l2p_table = NULL;      // entry는 atomic load / CAS (DFTL이면 NULL)
 static block_info_t *block_table = NULL;
-static int current_block_index = 0;
-static int current_page_index = 0;
 
-int ftl_init(void) {
-    if (nand_init() != NAND_SUCCESS) return -1;
+// 물리 page -> LBA (P2L)와 block 별 valid bitmap: GC는 NAND OOB를 읽지 않고 valid page만 골라 봄
+// bit는 L2P(또는 GTD)가 그 page를 가리키는 동안 1: ftl_map / GC / map_program이 설치 직전에 set,
+// ftl_invalidate가 clear. 한 word를 여러 writer가 건드리므로 atomic or / and
+#define VALID_WORDS     ((PAGES_PER_BLOCK + 63) / 64)   // block 당 bitmap word 수
+static uint32_t *p2l = NULL;        // translation page는 MAP_OOB_TAG | 번호
+static uint64_t *valid_map = NULL;
+
+// OOB: [0..3] LBA (translation page는 MAP_OOB_TAG | 번호), [4..7] program 순번
+// 순번은 image를 다시 열 때 (ftl_mount) 같은 LBA의 copy 중 최신을 고르는 데 씀
+// GC copy-back은 원본 OOB를 그대로 옮기므로 relocation이 그 사이의 host write보다 새것으로 보이지 않음
+static uint32_t oob_seq = 0;        // atomic
+static die_info_t die_table[NAND_DIES];
+static unsigned next_die = 0;   // 다음 write를 받을 die (round robin striping, atomic)
+
+// host op latency histogram (virtual ns)
+// log-linear bucket: 2^e ~ 2^(e+1) 구간을 8등분 -> 오차 12.5% 이내
+#define LAT_SUB_BITS    3
+#define LAT_BUCKETS     (64 << LAT_SUB_BITS)
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t bucket[LAT_BUCKETS];
+} lat_hist_t;
+
+static lat_hist_t lat_hist[FTL_OP_COUNT];
+
+// free block watermark (per die)
+// free <= low  : host write가 foreground GC (emergency)
+// free <  high : ftl_idle() / ftl_gc_step()의 background GC 대상
+static int gc_low_wm = GC_RESERVED_BLOCKS;
+static int gc_high_wm = GC_HIGH_WATERMARK;
+static ftl_gc_policy_t gc_policy = FTL_GC_GREEDY;
+static int gc_policy_param = 0;     // d-choices: 표본 수, windowed: 창 크기
+static uint64_t bg_gc_count = 0;
+static int wl_dynamic = 1;          // free block을 erase 횟수 순으로 꺼냄 (0 = FIFO)
+static int wl_spread = 0;           // static wear leveling 기준 erase 횟수 차 (0 = off)
+static uint64_t wl_count = 0;       // static wear leveling으로 옮긴 block (atomic)
+
+// epoch 기반 erase 보호: host read는 lock 없이 L2P 조회 -> nand_read
+// reader는 현재 epoch(0/1)의 counter를 올린 채로 page를 읽고, GC는 victim erase 전에
+// epoch을 넘기고 이전 epoch의 reader가 모두 빠질 때까지 기다림 (grace period)
+// counter는 thread 별 stripe로 나눠 cache line 경합을 줄임
+#define EPOCH_STRIPES   16
+
+typedef struct {
+    uint64_t active;
+    uint8_t pad[56];
+} epoch_slot_t;
+
+static epoch_slot_t epoch_readers[2][EPOCH_STRIPES] __attribute__((aligned(64)));
+static unsigned epoch_cur = 0;
+static unsigned epoch_next_stripe = 0;
+static __thread int epoch_stripe = -1;
+static pthread_mutex_t epoch_lock = PTHREAD_MUTEX_INITIALIZER;     // grace period 직렬화
+
+// background GC thread (ftl_bg_gc_start)
+static pthread_t bg_gc_thread;
+static int bg_gc_running = 0;
+
+// 아래 counter는 여러 die lock 아래에서 갱신되므로 atomic
+static int free_total = 0;
+static int free_min = 0;        // lowest pool depth seen
+static uint64_t gc_count = 0;
+static uint64_t host_pages = 0;     // host가 쓴 page
+static uint64_t nand_pages = 0;     // NAND에 program 된 host page (write buffer 통과 후)
+static uint64_t gc_pages = 0;       // GC copy-back page
+static uint64_t trim_pages = 0;     // ftl_trim으로 unmap 된 page
+static uint64_t gc_ns = 0;          // GC 단계에서 쓴 wall-clock 시간 (simulator CPU 비용)
+static uint64_t gc_nand_ns = 0;     // 그 중 copy-back / erase HAL 호출 (실제 장치에서는 chip이 하는 일)
+
+// block timestamp의 시계: host가 쓴 page 수
+static inline uint64_t gc_now(void) {
+    return __atomic_load_n(&host_pages, __ATOMIC_RELAXED);
+}
+
+// write-back buffer (ftl_set_write_buffer): hot LBA의 덮어쓰기를 DRAM에서 흡수
+// CLOCK 교체, 꽉 차면 WB_FLUSH_BATCH 개를 모아 die들에 stripe 해서 한 번에 program
+// wb_slot[lba]는 atomic: -1이면 read는 lock 없이 NAND로 감 (flush는 L2P 갱신 후에 -1로 바꿈)
+#define WB_FLUSH_BATCH  (NAND_DIES * 4)
+#define WB_SELECTED     2           // wb_ref: 이번 flush batch에 이미 들어간 slot
+
+static int wb_pages = 0;            // 0 = off
+static uint8_t *wb_data = NULL;
+static uint8_t *wb_stage = NULL;    // flush batch를 모으는 곳 (wb_lock 아래에서만 사용)
+static uint32_t *wb_lba = NULL;     // slot -> lba (0xFFFFFFFF = free)
+static uint8_t *wb_ref = NULL;      // CLOCK reference bit
+static uint8_t *wb_stream = NULL;   // slot -> write stream
+static int *wb_slot = NULL;         // lba -> slot (-1 = NAND에 있음)
+static int *wb_free = NULL;         // free slot stack
+static int wb_free_count = 0;
+static int wb_hand = 0;
+static uint64_t wb_hits = 0;        // buffer 안에서 덮어쓴 write
+static pthread_mutex_t wb_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// hot / cold 분류 (ftl_set_hot_cold): LBA 별 write 빈도 counter, logical 용량만큼 write 할 때마다 반으로 줄임
+// (최근 write에 무게를 둔 빈도). HOT_HEAT 이상이면 hot stream으로
+// counter는 relaxed load / store: 동시 write로 증가가 가끔 빠져도 분류에는 지장 없음
+#define HOT_HEAT        4
+
+static uint8_t *heat = NULL;        // NULL = 분류 off
+
+// write 한 번을 세고 hot이면 1
+static int heat_touch(uint32_t lba) {
+    uint8_t h = __atomic_load_n(&heat[lba], __ATOMIC_RELAXED);
+    if (h < 255) __atomic_store_n(&heat[lba], (uint8_t)(h + 1), __ATOMIC_RELAXED);
+    return h + 1 >= HOT_HEAT;
+}
+
+static void heat_decay(void) {
+    for (uint32_t l = 0; l < LOGICAL_PAGES_COUNT; l++) {
+        __atomic_store_n(&heat[l], (uint8_t)(__atomic_load_n(&heat[l], __ATOMIC_RELAXED) >> 1), __ATOMIC_RELAXED);
+    }
+}
+
+// read cache (ftl_set_read_cache): NAND에서 읽은 page를 LBA 기준으로 보관, CLOCK 교체
+// host write가 L2P를 바꾸면 해당 LBA를 버림. GC relocation은 data가 같으므로 그대로 둠
+// fill은 읽은 ppa가 아직 L2P와 같을 때만 (그 사이 write가 있었으면 옛 data를 넣지 않음)
+static int rc_pages = 0;            // 0 = off
+static uint8_t *rc_data = NULL;
+static uint32_t *rc_lba = NULL;     // slot -> lba (0xFFFFFFFF = free)
+static uint8_t *rc_ref = NULL;
+static int *rc_slot = NULL;         // lba -> slot (-1 = 없음), atomic
+static int rc_hand = 0;
+static uint64_t rc_hits = 0;
+static uint64_t rc_misses = 0;
+static pthread_mutex_t rc_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// demand-paged mapping (DFTL, ftl_set_map_cache)
+// L2P는 NAND의 translation page (page 당 MAP_ENTRIES 개)에 두고, DRAM에는
+// GTD (translation page 번호 -> ppa)와 CMT (최근 쓴 entry의 cache, CLOCK 교체)만 둠
+// dirty entry를 내보낼 때는 같은 translation page의 dirty entry를 모아 한 번에 다시 씀 (batch update)
+// translation page는 die 마다 별도 map block에 쓰고, OOB에는 MAP_OOB_TAG | 번호를 기록 (GC가 구분)
+//
+// CMT miss가 NAND read / program으로 이어지므로 DFTL에서는 map_lock 하나로 FTL 경로 전체를 직렬화
+// (host read / write, GC 모두 map_lock -> die lock 순서, map_lock 아래에서는 die 상태도 보호됨)
+#define MAP_ENTRIES     (NAND_PAGE_SIZE / (int)sizeof(uint32_t))
+#define MAP_PAGES       ((int)((LOGICAL_PAGES_COUNT + MAP_ENTRIES - 1) / MAP_ENTRIES))
+#define MAP_OOB_TAG     0x80000000u
+#define CMT_REF         1
+#define CMT_DIRTY       2
+
+static int cmt_size = 0;            // 0 = 전체 L2P를 DRAM에 (default)
+static int cmt_used = 0;
+static int cmt_hand = 0;
+static uint32_t *cmt_lba = NULL;
+static uint32_t *cmt_ppa = NULL;
+static uint8_t *cmt_flags = NULL;   // CMT_REF | CMT_DIRTY
+static int *cmt_head = NULL;        // hash bucket (lba & cmt_mask) -> slot
+static int *cmt_next = NULL;
+static uint32_t cmt_mask = 0;
+static uint32_t *gtd = NULL;        // translation page 번호 -> ppa (0xFFFFFFFF = 전부 unmapped), MAP_PAGES 개
+static unsigned map_die = 0;        // 다음 translation page를 받을 die
+static uint64_t cmt_hits = 0;
+static uint64_t cmt_misses = 0;
+static uint64_t map_reads = 0;      // translation page read
+static uint64_t map_writes = 0;     // translation page program
+static pthread_mutex_t map_lock = PTHREAD_MUTEX_INITIALIZER;
+// translation page scratch (map_lock 아래): 크기가 page 크기를 따르므로 stack 대신 ftl_init에서 할당
+static uint32_t *map_entries = NULL;    // 읽어 올린 page (cmt_load / map_collect / ftl_set_map_cache)
+static uint32_t *flush_entries = NULL;  // map_writeback이 다시 쓰는 page (cmt_load 도중에도 불림)
+static int *flush_slots = NULL;         // 그 page에서 반영한 CMT slot
+
+// extent L2P (ftl_set_extent_map): 연속 LBA -> 연속 PPA 구간을 extent 하나로 (ftl_extent.c)
+// segment 안이 조각나면 page 별 entry로 돌아감. 갱신이 배열 이동 / 재할당이라 DFTL처럼 map_lock 아래에서
+static extent_map_t ext_map;
+static int ext_on = 0;
+static int map_serial = 0;          // flat L2P가 아님 (DFTL / extent): FTL 경로를 map_lock으로 직렬화
+
+// host program 경로의 scratch (lbas / OOB): 크기가 geometry를 따르므로 stack 대신 ftl_init에서 미리 할당
+// host write는 lock 없이 여러 thread에서 오므로 slot을 bitmap으로 빌려 씀 (다 쓰이면 빌 때까지 양보)
+#define FTL_SCRATCH_SLOTS   64
+typedef struct {
+    uint32_t *lbas;             // PAGES_PER_BLOCK 개 (write_run)
+    uint8_t *spare;             // scratch_run 개 page의 OOB (ftl_program_run의 die 당 구간)
+} ftl_scratch_t;
+
+static ftl_scratch_t scratch[FTL_SCRATCH_SLOTS];
+static uint8_t *scratch_mem = NULL;
+static int scratch_run = 0;
+static uint64_t scratch_busy = 0;   // atomic, bit i = scratch[i] 사용 중
+
+static ftl_scratch_t *scratch_get(void) {
+    for (;;) {
+        uint64_t busy = __atomic_load_n(&scratch_busy, __ATOMIC_ACQUIRE);
+        if (busy == ~0ULL) {
+            sched_yield();
+            continue;
+        }
+        int i = __builtin_ctzll(~busy);
+        if (__atomic_compare_exchange_n(&scratch_busy, &busy, busy | (1ULL << i), 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) return &scratch[i];
+    }
+}
+
+static void scratch_put(ftl_scratch_t *sc) {
+    __atomic_fetch_and(&scratch_busy, ~(1ULL << (sc - scratch)), __ATOMIC_RELEASE);
+}
+
+static int scratch_alloc(void) {
+    // program 한 번은 최대 PAGES_PER_BLOCK (write_run) 또는 WB_FLUSH_BATCH page를 die들에 나눔
+    int run = PAGES_PER_BLOCK > WB_FLUSH_BATCH ? PAGES_PER_BLOCK : WB_FLUSH_BATCH;
+    size_t lbas = sizeof(uint32_t) * PAGES_PER_BLOCK;
+    scratch_run = (run + NAND_DIES - 1) / NAND_DIES;
+    size_t slot = lbas + (size_t)scratch_run * NAND_OOB_SIZE;
+
+    scratch_mem = (uint8_t *)malloc(slot * FTL_SCRATCH_SLOTS);
+    map_entries = (uint32_t *)malloc(NAND_PAGE_SIZE);
+    flush_entries = (uint32_t *)malloc(NAND_PAGE_SIZE);
+    flush_slots = (int *)malloc(sizeof(int) * MAP_ENTRIES);
+    if (!scratch_mem || !map_entries || !flush_entries || !flush_slots) return -1;
+    for (int i = 0; i < FTL_SCRATCH_SLOTS; i++) {
+        scratch[i].lbas = (uint32_t *)(scratch_mem + slot * i);
+        scratch[i].spare = scratch_mem + slot * i + lbas;
+    }
+    scratch_busy = 0;
+    return 0;
+}
+
+// ftl_init이 만든 table과 die 상태를 반납 (ftl_exit, ftl_init 실패), dies = lock을 초기화한 die 수
+static void ftl_free_tables(int dies) {
+    free(l2p_table);
+    free(block_table);
+    free(gtd);
+    free(p2l);
+    free(valid_map);
+    free(scratch_mem);
+    free(map_entries);
+    free(flush_entries);
+    free(flush_slots);
+    l2p_table = NULL;
+    block_table = NULL;
+    gtd = NULL;
+    p2l = NULL;
+    valid_map = NULL;
+    scratch_mem = NULL;
+    map_entries = flush_entries = NULL;
+    flush_slots = NULL;
+    ftl_logical_pages = DEFAULT_LOGICAL_PAGES;
+    for (int d = 0; d < NAND_DIES; d++) {
+        free(die_table[d].free_pool);
+        die_table[d].free_pool = NULL;
+        victim_index_free(&die_table[d].victim_idx);
+        if (d < dies) pthread_mutex_destroy(&die_table[d].lock);
+    }
+}
+
+int ftl_init(const nand_config_t *nand_cfg) {
+    int dies = 0;
+    if (nand_init(nand_cfg) != NAND_SUCCESS) return -1;
+
+    // logical 용량: 물리 page에서 over-provisioning 만큼 뺌
+    uint64_t physical = (uint64_t)BLOCKS_PER_CHIP * PAGES_PER_BLOCK;
+    uint32_t op = nand_cfg ? nand_cfg->geometry.op_percent : 0;
+    uint64_t logical = op ? physical * 100 / (100 + op)
+                          : physical * DEFAULT_LOGICAL_PAGES / ((uint64_t)NAND_DEFAULT_BLOCKS * NAND_DEFAULT_PAGES_PER_BLOCK);
+    // die 마다 GC 예약분 + host / GC open block 이상의 여유 block이 있어야 GC가 진행됨
+    if (logical == 0 || (physical - logical) / PAGES_PER_BLOCK < (uint64_t)NAND_DIES * (GC_RESERVED_BLOCKS + 2)) {
+        printf("[Error] Over-provisioning too small (%llu of %llu pages spare)\n",
+               (unsigned long long)(physical - logical), (unsigned long long)physical);
+        goto fail;
+    }
+    ftl_logical_pages = (uint32_t)logical;
 
     l2p_table = (uint32_t *)malloc(sizeof(uint32_t) * LOGICAL_PAGES_COUNT);
+    block_table = (block_info_t *)malloc(sizeof(block_info_t) * BLOCKS_PER_CHIP);
+    gtd = (uint32_t *)malloc(sizeof(uint32_t) * MAP_PAGES);
+    p2l = (uint32_t *)malloc(sizeof(uint32_t) * BLOCKS_PER_CHIP * PAGES_PER_BLOCK);
+    valid_map = (uint64_t *)calloc((size_t)BLOCKS_PER_CHIP * VALID_WORDS, sizeof(uint64_t));
+    if (!l2p_table || !block_table || !gtd || !p2l || !valid_map || scratch_alloc() != 0) goto fail;
+    memset(p2l, 0xFF, sizeof(uint32_t) * BLOCKS_PER_CHIP * PAGES_PER_BLOCK);
     memset(l2p_table, 0xFF, sizeof(uint32_t) * LOGICAL_PAGES_COUNT);
 
-    block_table = (block_info_t *)malloc(sizeof(block_info_t) * BLOCKS_PER_CHIP);
     for(int i=0; i<BLOCKS_PER_CHIP; i++) {
         block_table[i].invalid_page_count = 0;
-        block_table[i].is_free = 1;
+        block_table[i].is_free = 0;
+        block_table[i].programmed = 0;
+        block_table[i].mtime = 0;
     }
-    current_block_index = 0;
-    current_page_index = 0;
-    block_table[0].is_free = 0;
 
-    printf("[FTL] Init Complete. Logical Pages: %d\n", LOGICAL_PAGES_COUNT);
+    free_total = 0;
+    for (int d = 0; d < NAND_DIES; d++) {
+        die_info_t *die = &die_table[d];
+        pthread_mutex_init(&die->lock, NULL);
+        dies++;
+        die->free_pool = (int *)malloc(sizeof(int) * BLOCKS_PER_DIE);
+        if (!die->free_pool) goto fail;
+        if (victim_index_init(&die->victim_idx, BLOCKS_PER_DIE, PAGES_PER_BLOCK, d, NAND_DIES) != 0) goto fail;
+        die->free_count = 0;
+        die->free_seq = 0;
+        die->max_erase = 0;
+        die->wl_skip = 0;
+        die->gc_wl = 0;
+        die->gc_bad = 0;
+        for (int s = 0; s < FTL_STREAMS; s++) die->cursor[s] = CURSOR(-1, PAGES_PER_BLOCK);
+        die->gc_block = -1;
+        die->gc_page = PAGES_PER_BLOCK;
+        die->wl_block = -1;
+        die->wl_page = PAGES_PER_BLOCK;
+        die->gc_victim = -1;
+        die->map_block = -1;
+        die->map_page = PAGES_PER_BLOCK;
+        die->gc_seed = (unsigned)d + 1;
+    }
+    next_die = 0;
+    gc_count = 0;
+    bg_gc_count = 0;
+    wl_count = 0;
+    host_pages = nand_pages = gc_pages = wb_hits = trim_pages = gc_ns = gc_nand_ns = 0;
+    oob_seq = 0;
+
+    // 기존 image면 OOB에서 L2P / block 상태를 복원, 써 있는 block은 GC 후보로
+    if (nand_image_reused() && ftl_mount() != 0) goto fail;
+    // erase 횟수는 FILE image에 남아 있을 수 있음
+    wl_dynamic = 1;
+    wl_spread = 0;
+    for (int i = 0; i < BLOCKS_PER_CHIP; i++) {
+        if (nand_is_bad_block(i)) continue;
+        die_info_t *die = &die_table[NAND_BLOCK_DIE(i)];
+        if (nand_get_erase_count(i) > die->max_erase) die->max_erase = nand_get_erase_count(i);
+        if (block_table[i].programmed == 0) free_pool_push(i);
+    }
+    for (int d = 0; d < NAND_DIES; d++) {
+        // free block이 없는 die는 첫 write에서 GC로 확보
+        int block = free_pool_pop(d);
+        die_table[d].cursor[0] = block == -1 ? CURSOR(-1, PAGES_PER_BLOCK) : CURSOR(block, 0);
+    }
+    free_min = free_total;
+    rc_hits = rc_misses = 0;
+    memset(gtd, 0xFF, sizeof(uint32_t) * MAP_PAGES);
+    map_die = 0;
+    cmt_hits = cmt_misses = map_reads = map_writes = 0;
+    gc_low_wm = GC_RESERVED_BLOCKS;
+    gc_high_wm = GC_HIGH_WATERMARK;
+    gc_policy = FTL_GC_GREEDY;
+    gc_policy_param = 0;
+    memset(lat_hist, 0, sizeof(lat_hist));
+
+    printf("[FTL] Init Complete. Logical Pages: %u, Dies: %d, Page: %d B, Pages/Block: %d, Blocks: %d\n",
+           LOGICAL_PAGES_COUNT, NAND_DIES, NAND_PAGE_SIZE, PAGES_PER_BLOCK, BLOCKS_PER_CHIP);
+    return 0;
+
+fail:
+    // 여기까지 만든 것을 되돌림: table, die 상태, HAL (FILE image mapping / fd)
+    ftl_free_tables(dies);
+    nand_exit();
+    return -1;
+}
+
+static int lat_bucket(uint64_t ns) {
+    if (ns < (1 << LAT_SUB_BITS)) return (int)ns;
+    int e = 63 - __builtin_clzll(ns);
+    return ((e - LAT_SUB_BITS + 1) << LAT_SUB_BITS) + (int)((ns >> (e - LAT_SUB_BITS)) & ((1 << LAT_SUB_BITS) - 1));
+}
+
+// bucket에 들어가는 가장 큰 값
+static uint64_t lat_bucket_upper(int idx) {
+    if (idx < (1 << LAT_SUB_BITS)) return idx;
+    int shift = (idx >> LAT_SUB_BITS) - 1;
+    uint64_t lower = (uint64_t)((1 << LAT_SUB_BITS) + (idx & ((1 << LAT_SUB_BITS) - 1))) << shift;
+    return lower + (1ULL << shift) - 1;
+}
+
+// 여러 thread가 동시에 기록 (host clock은 공유되므로 multi-thread에서는 참고용)
+static void lat_record(ftl_op_t op, uint64_t start) {
+    lat_hist_t *h = &lat_hist[op];
+    uint64_t ns = nand_get_time() - start;
+    if ((int64_t)ns < 0) ns = 0;
+    __atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->sum, ns, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+    while (ns > max && !__atomic_compare_exchange_n(&h->max, &max, ns, 1,
+                                                   __ATOMIC_RELAXED, __ATOMIC_RELAXED)) ;
+    __atomic_fetch_add(&h->bucket[lat_bucket(ns)], 1, __ATOMIC_RELAXED);
+}
+
+// die의 stream open block을 새 free block으로 교체 (die lock 필요)
+// 이전 block은 예약된 page가 모두 program 되었을 때 GC 후보가 됨 (ftl_block_programmed)
+static int ftl_open_block(int die, int stream) {
+    die_info_t *d = &die_table[die];
+    int next = ftl_get_free_block(die, 0);
+    if (next == -1) return -1;
+    __atomic_store_n(&d->cursor[stream], CURSOR(next, 0), __ATOMIC_RELEASE);
     return 0;
 }
 
-void ftl_write(uint32_t lba, const uint8_t *buffer) {
-    if (lba >= LOGICAL_PAGES_COUNT) return;
+// die의 stream open block에서 최대 n page 예약, 예약한 page 수 반환 (0 = die full)
+// block 끝에 걸리면 남은 page만 받음, 다 찬 block을 본 thread는 die lock에서 교체를 기다림
+static int ftl_reserve(int die, int stream, int n, uint32_t *ppa) {
+    die_info_t *d = &die_table[die];
 
-    if (current_page_index >= PAGES_PER_BLOCK) {
-        int next = ftl_get_free_block();
-        if (next == -1) { printf("[Error] System Full\n"); return; }
-        current_block_index = next;
-        current_page_index = 0;
+    for (;;) {
+        uint64_t c = __atomic_fetch_add(&d->cursor[stream], (uint64_t)n, __ATOMIC_ACQ_REL);
+        uint32_t page = CURSOR_PAGE(c);
+        if (page < (uint32_t)PAGES_PER_BLOCK) {
+            if (n > PAGES_PER_BLOCK - (int)page) n = PAGES_PER_BLOCK - page;
+            *ppa = CURSOR_BLOCK(c) * PAGES_PER_BLOCK + page;
+            return n;
+        }
+
+        // 먼저 lock을 잡은 thread만 교체, 나머지는 새 cursor로 다시 시도
+        int ret = 0;
+        pthread_mutex_lock(&d->lock);
+        if (CURSOR_BLOCK(__atomic_load_n(&d->cursor[stream], __ATOMIC_ACQUIRE)) == CURSOR_BLOCK(c)) {
+            ret = ftl_open_block(die, stream);
+        }
+        pthread_mutex_unlock(&d->lock);
+        if (ret != 0) return 0;
     }
+}
+
+// program 완료 page 수를 올리고, block이 전부 써지면 victim index에 넣음
+// 예약만 되고 아직 program / L2P 갱신 전인 page가 남은 block은 GC가 고르지 않음
+static void ftl_block_programmed(int block, int n) {
+    if (__atomic_add_fetch(&block_table[block].programmed, n, __ATOMIC_ACQ_REL) < PAGES_PER_BLOCK) return;
+
+    die_info_t *d = &die_table[NAND_BLOCK_DIE(block)];
+    pthread_mutex_lock(&d->lock);
+    ftl_block_close(block);
+    pthread_mutex_unlock(&d->lock);
+}
+
+// program 실패한 block을 bad로 표시 (grown bad block), 이후 새 page를 받지 않고
+// 닫힌 뒤 GC가 남은 valid page를 옮기고 erase 하면 free pool로 돌아가지 않음
+static void ftl_mark_bad(uint32_t ppa, int err) {
+    printf("[Error] Program failed at block %d page %d (%d), retiring block\n", PPA_BLOCK(ppa), PPA_PAGE(ppa), err);
+    nand_mark_bad_block(PPA_BLOCK(ppa));
+}
 
-    uint32_t target_ppa = current_block_index * PAGES_PER_BLOCK + current_page_index;
-    uint32_t old_ppa = l2p_table[lba];
-    if (old_ppa != 0xFFFFFFFF) block_table[old_ppa / PAGES_PER_BLOCK].invalid_page_count++;
+// host write의 program 실패: 실패한 n page는 map 하지 않고 invalid로,
+// 아직 아무도 예약하지 않은 나머지 page도 cursor를 block 끝으로 옮겨 invalid로 셈
+// 먼저 예약한 다른 thread의 program이 끝나면 block이 닫혀 GC 후보가 됨
+static void ftl_program_failed(int die, int stream, uint32_t ppa, int n, int err) {
+    die_info_t *d = &die_table[die];
+    int block = PPA_BLOCK(ppa), rest = 0;
+
+    ftl_mark_bad(ppa, err);
+    pthread_mutex_lock(&d->lock);
+    uint64_t c = __atomic_load_n(&d->cursor[stream], __ATOMIC_ACQUIRE);
+    while (CURSOR_BLOCK(c) == block && CURSOR_PAGE(c) < (uint32_t)PAGES_PER_BLOCK) {
+        if (__atomic_compare_exchange_n(&d->cursor[stream], &c, CURSOR(block, PAGES_PER_BLOCK), 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            rest = PAGES_PER_BLOCK - CURSOR_PAGE(c);
+            break;
+        }
+    }
+    block_table[block].invalid_page_count += n + rest;
+    pthread_mutex_unlock(&d->lock);
+    ftl_block_programmed(block, n + rest);
+}
+
+// GC / map block의 program 실패: ppa부터 block 끝까지 invalid로 두고 다음 alloc에서 block 교체
+// (next_page는 그 block의 append 위치, GC는 die lock / map은 map_lock 아래)
+static void ftl_retire_append(uint32_t ppa, int *next_page, int err) {
+    int block = PPA_BLOCK(ppa);
+    ftl_mark_bad(ppa, err);
+    block_table[block].invalid_page_count += PAGES_PER_BLOCK - PPA_PAGE(ppa);
+    *next_page = PAGES_PER_BLOCK;
+}
+
+static void valid_set(uint32_t ppa, uint32_t lba) {
+    int page = PPA_PAGE(ppa);
+    p2l[ppa] = lba;
+    __atomic_fetch_or(&valid_map[(size_t)PPA_BLOCK(ppa) * VALID_WORDS + page / 64], 1ULL << (page % 64),
+                      __ATOMIC_RELAXED);
+}
+
+static void valid_clear(uint32_t ppa) {
+    int page = PPA_PAGE(ppa);
+    __atomic_fetch_and(&valid_map[(size_t)PPA_BLOCK(ppa) * VALID_WORDS + page / 64], ~(1ULL << (page % 64)),
+                       __ATOMIC_RELAXED);
+}
+
+// block에서 page 이후 첫 valid page (-1 = 없음)
+static int valid_next(int block, int page) {
+    const uint64_t *w = &valid_map[(size_t)block * VALID_WORDS];
+    for (int i = page / 64; i < VALID_WORDS; i++) {
+        uint64_t bits = __atomic_load_n(&w[i], __ATOMIC_RELAXED);
+        if (i == page / 64) bits &= ~0ULL << (page % 64);
+        if (bits) return i * 64 + __builtin_ctzll(bits);
+    }
+    return -1;
+}
 
-    uint8_t spare[NAND_OOB_SIZE];
+static void oob_fill(uint8_t *spare, uint32_t lba) {
+    uint32_t seq = __atomic_fetch_add(&oob_seq, 1, __ATOMIC_RELAXED);
     memset(spare, 0xFF, NAND_OOB_SIZE);
     memcpy(spare, &lba, sizeof(uint32_t));
+    memcpy(spare + sizeof(uint32_t), &seq, sizeof(uint32_t));
+}
+
+// 기존 image의 OOB를 훑어 L2P / P2L / valid bitmap / block 상태를 다시 만듦 (ftl_init, flat L2P)
+// LBA마다 순번이 가장 큰 copy가 valid. 써 있는 block은 끝까지 닫힌 것으로 보고 GC 후보에 넣음
+// (안 쓴 page도 erase로 되찾을 공간이므로 invalid로 셈). translation page는 전부 invalid:
+// data page의 OOB만으로 L2P가 복원되고 GTD는 비어서 시작함
+// DRAM에만 있는 상태는 복원되지 않음: trim은 OOB에 남지 않으므로 trim한 LBA는 이전 data로 돌아옴
+static int ftl_mount(void) {
+    uint32_t *seq = (uint32_t *)malloc(sizeof(uint32_t) * LOGICAL_PAGES_COUNT);
+    ppa_t *ppas = (ppa_t *)malloc(sizeof(ppa_t) * PAGES_PER_BLOCK);
+    uint8_t *oob = (uint8_t *)malloc((size_t)PAGES_PER_BLOCK * NAND_OOB_SIZE);
+    uint32_t next_seq = 0, mapped = 0;
+    int used = 0;
+
+    if (!seq || !ppas || !oob) {
+        free(seq);
+        free(ppas);
+        free(oob);
+        return -1;
+    }
+    for (int b = 0; b < BLOCKS_PER_CHIP; b++) {
+        int n = 0;
+        // 은퇴한 bad block에도 GC가 아직 옮기지 않은 data가 있을 수 있음 (free pool에는 안 들어감)
+        for (int p = 0; p < PAGES_PER_BLOCK; p++) {
+            uint32_t ppa = (uint32_t)b * PAGES_PER_BLOCK + p;
+            if (nand_is_written(ppa)) ppas[n++] = ppa;
+        }
+        if (n == 0) continue;
+
+        nand_read_multi(ppas, n, NULL, oob);
+        block_table[b].programmed = PAGES_PER_BLOCK;
+        block_table[b].invalid_page_count = PAGES_PER_BLOCK;
+        for (int i = 0; i < n; i++) {
+            uint32_t lba, s;
+            memcpy(&lba, oob + (size_t)i * NAND_OOB_SIZE, sizeof(uint32_t));
+            memcpy(&s, oob + (size_t)i * NAND_OOB_SIZE + sizeof(uint32_t), sizeof(uint32_t));
+            if (used++ == 0 || (int32_t)(s - next_seq) >= 0) next_seq = s + 1;
+            if (lba >= LOGICAL_PAGES_COUNT) continue;
+
+            // 순번이 같으면 GC가 옮기던 중인 같은 data: 어느 쪽이든 무방
+            uint32_t old = l2p_table[lba];
+            if (old != 0xFFFFFFFF) {
+                if ((int32_t)(s - seq[lba]) < 0) continue;
+                valid_clear(old);
+                block_table[PPA_BLOCK(old)].invalid_page_count++;
+                mapped--;
+            }
+            l2p_table[lba] = ppas[i];
+            seq[lba] = s;
+            valid_set(ppas[i], lba);
+            block_table[b].invalid_page_count--;
+            mapped++;
+        }
+    }
+    // 닫힌 block은 invalid 수가 확정된 뒤에 victim index로
+    for (int b = 0; b < BLOCKS_PER_CHIP; b++) {
+        if (block_table[b].programmed) ftl_block_close(b);
+    }
+    oob_seq = next_seq;
+    free(seq);
+    free(ppas);
+    free(oob);
+    printf("[FTL] Mounted existing image: %u mapped pages\n", mapped);
+    return 0;
+}
+
+// host write / trim의 L2P 갱신 (trim은 ppa 0xFFFFFFFF), 이전 ppa 반환
+// 이전 위치 die의 lock 아래에서 CAS -> 같은 die의 GC relocation과 엇갈리지 않고,
+// GC는 victim을 erase 하기 전에 모든 invalidate를 반영한 상태를 봄
+static uint32_t ftl_map(uint32_t lba, uint32_t ppa) {
+    uint32_t old;
+    // 설치 전에 set: block이 다 program 되기 전이라 GC는 아직 이 page를 보지 않음
+    if (ppa != 0xFFFFFFFF) valid_set(ppa, lba);
+    if (map_serial) {
+        // DFTL / extent: map_lock 아래이므로 CAS / die lock 불필요
+        old = l2p_set(lba, ppa);
+        if (old != 0xFFFFFFFF) ftl_invalidate(old);
+        if (rc_pages) rc_invalidate(lba);
+        return old;
+    }
+    for (;;) {
+        old = __atomic_load_n(&l2p_table[lba], __ATOMIC_ACQUIRE);
+        if (old == 0xFFFFFFFF) {
+            if (__atomic_compare_exchange_n(&l2p_table[lba], &old, ppa, 0,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_ACQUIRE)) break;
+            continue;
+        }
+
+        die_info_t *d = &die_table[NAND_BLOCK_DIE(PPA_BLOCK(old))];
+        pthread_mutex_lock(&d->lock);
+        int ok = __atomic_compare_exchange_n(&l2p_table[lba], &old, ppa, 0,
+                                             __ATOMIC_SEQ_CST, __ATOMIC_ACQUIRE);
+        if (ok) ftl_invalidate(old);
+        pthread_mutex_unlock(&d->lock);
+        if (ok) break;
+    }
+    // L2P를 바꾼 뒤에 버려야 동시에 진행 중인 fill이 옛 data를 남기지 않음
+    if (rc_pages) rc_invalidate(lba);
+    return old;
+}
+
+// lbas[i]의 data를 die들에 stripe 하면서 stream의 open block에 append
+// die 당 연속 구간(chunk)은 nand_write_seq 한 번으로 씀 (OOB는 sc->spare에 채움)
+// program 실패한 구간은 block을 은퇴시키고 다른 die에서 다시 씀, 쓴 page 수 반환 (n보다 작으면 실패)
+static int program_run(ftl_scratch_t *sc, const uint32_t *lbas, int n, const uint8_t *data, int stream) {
+    int chunk = (n + NAND_DIES - 1) / NAND_DIES;
+    uint8_t *spare = sc->spare;
+    int done = 0, failed = 0, errors = 0;
+
+    map_lock_acquire();
+    while (done < n) {
+        int die = __atomic_fetch_add(&next_die, 1, __ATOMIC_RELAXED) % NAND_DIES;
+        uint32_t start_ppa;
+
+        int run = n - done;
+        if (run > chunk) run = chunk;
+        run = ftl_reserve(die, stream, run, &start_ppa);
+        if (run == 0) {
+            // 이 die는 공간 없음 -> 다음 die로
+            if (++failed >= NAND_DIES) { printf("[Error] System Full\n"); break; }
+            continue;
+        }
+        failed = 0;
+
+        for (int i = 0; i < run; i++) oob_fill(spare + i * NAND_OOB_SIZE, lbas[done + i]);
+
+        // program -> L2P -> programmed 순서: GC 후보가 될 때는 L2P가 이미 새 위치를 가리킴
+        int ret = nand_write_seq(start_ppa, run, data + (size_t)done * NAND_PAGE_SIZE, spare);
+        if (ret != NAND_SUCCESS) {
+            // L2P는 이전 data를 그대로 가리킴
+            ftl_program_failed(die, stream, start_ppa, run, ret);
+            if (++errors >= NAND_DIES) { printf("[Error] Program failed on every die\n"); break; }
+            continue;
+        }
+        errors = 0;
+        for (int i = 0; i < run; i++) ftl_map(lbas[done + i], start_ppa + i);
+        ftl_block_programmed(PPA_BLOCK(start_ppa), run);
+        __atomic_fetch_add(&nand_pages, run, __ATOMIC_RELAXED);
+        done += run;
+    }
+    map_lock_release();
+    return done;
+}
+
+static int ftl_program_run(const uint32_t *lbas, int n, const uint8_t *data, int stream) {
+    ftl_scratch_t *sc = scratch_get();
+    int done = program_run(sc, lbas, n, data, stream);
+    scratch_put(sc);
+    return done;
+}
+
+// CLOCK으로 최대 max 개 slot을 골라 NAND에 program 하고 비움 (wb_lock 필요)
+// 고른 slot은 stream 별로 모아 stream 마다 한 번씩 program, 비운 slot 수 반환 (0 = 공간 없음)
+static int wb_evict(int max) {
+    uint32_t lbas[WB_FLUSH_BATCH];
+    int slots[WB_FLUSH_BATCH], picked[WB_FLUSH_BATCH];
+    uint8_t ok[WB_FLUSH_BATCH];
+    int n = 0, m = 0, done = 0;
+
+    if (max > WB_FLUSH_BATCH) max = WB_FLUSH_BATCH;
+    if (max > wb_pages - wb_free_count) max = wb_pages - wb_free_count;
+    while (n < max) {
+        int s = wb_hand;
+        wb_hand = (wb_hand + 1) % wb_pages;
+        if (wb_lba[s] == 0xFFFFFFFF || wb_ref[s] == WB_SELECTED) continue;
+        if (wb_ref[s]) { wb_ref[s] = 0; continue; }
+        wb_ref[s] = WB_SELECTED;
+        picked[n++] = s;
+    }
+
+    for (int st = 0; st < FTL_STREAMS && m < n; st++) {
+        int first = m;
+        for (int i = 0; i < n; i++) {
+            int s = picked[i];
+            if (wb_stream[s] != st) continue;
+            slots[m] = s;
+            lbas[m] = wb_lba[s];
+            memcpy(wb_stage + (size_t)m * NAND_PAGE_SIZE, wb_data + (size_t)s * NAND_PAGE_SIZE, NAND_PAGE_SIZE);
+            m++;
+        }
+        if (m == first) continue;
+        int run = ftl_program_run(lbas + first, m - first, wb_stage + (size_t)first * NAND_PAGE_SIZE, st);
+        for (int i = first; i < m; i++) ok[i] = i - first < run;
+        done += run;
+    }
+    for (int i = 0; i < n; i++) {
+        int s = slots[i];
+        wb_ref[s] = 0;
+        if (!ok[i]) continue;       // program 못한 page는 buffer에 남김
+        __atomic_store_n(&wb_slot[lbas[i]], -1, __ATOMIC_RELEASE);
+        wb_lba[s] = 0xFFFFFFFF;
+        wb_free[wb_free_count++] = s;
+    }
+    return done;
+}
+
+// buffer에 넣음, 이미 있는 LBA면 그 자리에 덮어씀 (stream은 마지막 write 기준)
+static int wb_write(uint32_t lba, const uint8_t *buffer, int stream) {
+    pthread_mutex_lock(&wb_lock);
+    int s = wb_slot[lba];
+    if (s >= 0) {
+        wb_hits++;
+    } else {
+        if (wb_free_count == 0 && wb_evict(WB_FLUSH_BATCH) == 0) {
+            pthread_mutex_unlock(&wb_lock);
+            return -1;
+        }
+        s = wb_free[--wb_free_count];
+        wb_lba[s] = lba;
+    }
+    memcpy(wb_data + (size_t)s * NAND_PAGE_SIZE, buffer, NAND_PAGE_SIZE);
+    wb_ref[s] = 1;
+    wb_stream[s] = (uint8_t)stream;
+    __atomic_store_n(&wb_slot[lba], s, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&wb_lock);
+    return 0;
+}
+
+// buffer에 있으면 복사하고 1 반환
+static int wb_read(uint32_t lba, uint8_t *buffer) {
+    if (__atomic_load_n(&wb_slot[lba], __ATOMIC_ACQUIRE) < 0) return 0;
+
+    pthread_mutex_lock(&wb_lock);
+    int s = wb_slot[lba];
+    if (s >= 0) memcpy(buffer, wb_data + (size_t)s * NAND_PAGE_SIZE, NAND_PAGE_SIZE);
+    pthread_mutex_unlock(&wb_lock);
+    return s >= 0;
+}
+
+// NAND에 바로 쓰는 범위의 buffer 사본을 버림 (program 전에: 나중에 옛 data가 flush 되지 않도록)
+static void wb_drop(uint32_t lba, int count) {
+    pthread_mutex_lock(&wb_lock);
+    for (uint32_t l = lba; l < lba + (uint32_t)count; l++) {
+        int s = wb_slot[l];
+        if (s < 0) continue;
+        __atomic_store_n(&wb_slot[l], -1, __ATOMIC_RELEASE);
+        wb_lba[s] = 0xFFFFFFFF;
+        wb_ref[s] = 0;
+        wb_free[wb_free_count++] = s;
+    }
+    pthread_mutex_unlock(&wb_lock);
+}
+
+int ftl_flush(void) {
+    int ret = 0;
+    if (!wb_pages) return 0;
+
+    pthread_mutex_lock(&wb_lock);
+    while (wb_free_count < wb_pages) {
+        if (wb_evict(WB_FLUSH_BATCH) == 0) { ret = -1; break; }
+    }
+    pthread_mutex_unlock(&wb_lock);
+    return ret;
+}
+
+static void wb_release(void) {
+    free(wb_data);
+    free(wb_stage);
+    free(wb_lba);
+    free(wb_ref);
+    free(wb_stream);
+    free(wb_slot);
+    free(wb_free);
+    wb_data = wb_stage = NULL;
+    wb_lba = NULL;
+    wb_ref = wb_stream = NULL;
+    wb_slot = NULL;
+    wb_free = NULL;
+    wb_pages = wb_free_count = wb_hand = 0;
+}
+
+int ftl_set_write_buffer(int pages) {
+    if (pages < 0) return -1;
+    if (ftl_flush() != 0) return -1;
+    wb_release();
+    if (pages == 0) return 0;
+
+    wb_data = (uint8_t *)malloc((size_t)pages * NAND_PAGE_SIZE);
+    wb_stage = (uint8_t *)malloc((size_t)WB_FLUSH_BATCH * NAND_PAGE_SIZE);
+    wb_lba = (uint32_t *)malloc(sizeof(uint32_t) * pages);
+    wb_ref = (uint8_t *)calloc(pages, 1);
+    wb_stream = (uint8_t *)calloc(pages, 1);
+    wb_slot = (int *)malloc(sizeof(int) * LOGICAL_PAGES_COUNT);
+    wb_free = (int *)malloc(sizeof(int) * pages);
+    if (!wb_data || !wb_stage || !wb_lba || !wb_ref || !wb_stream || !wb_slot || !wb_free) {
+        wb_release();
+        return -1;
+    }
+    memset(wb_lba, 0xFF, sizeof(uint32_t) * pages);
+    memset(wb_slot, 0xFF, sizeof(int) * LOGICAL_PAGES_COUNT);
+    for (int i = 0; i < pages; i++) wb_free[i] = pages - 1 - i;
+    wb_free_count = pages;
+    wb_pages = pages;
+    return 0;
+}
+
+int ftl_set_hot_cold(int on) {
+    free(heat);
+    heat = NULL;
+    if (!on) return 0;
+    heat = (uint8_t *)calloc(LOGICAL_PAGES_COUNT, 1);
+    return heat ? 0 : -1;
+}
+
+// read cache hit이면 복사하고 1 반환
+static int rc_lookup(uint32_t lba, uint8_t *buffer) {
+    int s = __atomic_load_n(&rc_slot[lba], __ATOMIC_ACQUIRE);
+    if (s >= 0) {
+        pthread_mutex_lock(&rc_lock);
+        s = rc_slot[lba];
+        if (s >= 0) {
+            memcpy(buffer, rc_data + (size_t)s * NAND_PAGE_SIZE, NAND_PAGE_SIZE);
+            rc_ref[s] = 1;
+        }
+        pthread_mutex_unlock(&rc_lock);
+    }
+    __atomic_fetch_add(s >= 0 ? &rc_hits : &rc_misses, 1, __ATOMIC_RELAXED);
+    return s >= 0;
+}
+
+// ppa에서 읽은 data를 넣음 (L2P가 그 사이 바뀌었으면 넣지 않음)
+static void rc_fill(uint32_t lba, uint32_t ppa, const uint8_t *buffer) {
+    pthread_mutex_lock(&rc_lock);
+    // DFTL / extent는 map_lock 아래라 그 사이 write가 없음
+    if (rc_slot[lba] < 0 && (map_serial || __atomic_load_n(&l2p_table[lba], __ATOMIC_SEQ_CST) == ppa)) {
+        int s;
+        for (;;) {
+            s = rc_hand;
+            rc_hand = (rc_hand + 1) % rc_pages;
+            if (rc_lba[s] == 0xFFFFFFFF || !rc_ref[s]) break;
+            rc_ref[s] = 0;
+        }
+        if (rc_lba[s] != 0xFFFFFFFF) __atomic_store_n(&rc_slot[rc_lba[s]], -1, __ATOMIC_RELEASE);
+        memcpy(rc_data + (size_t)s * NAND_PAGE_SIZE, buffer, NAND_PAGE_SIZE);
+        rc_lba[s] = lba;
+        rc_ref[s] = 0;      // 다시 읽혀야 reference (한 번 읽고 마는 page가 hot page를 밀어내지 않게)
+        // seq_cst: L2P 확인 -> slot 설치 와 write의 L2P 변경 -> slot 확인 이 서로를 놓치지 않게
+        __atomic_store_n(&rc_slot[lba], s, __ATOMIC_SEQ_CST);
+    }
+    pthread_mutex_unlock(&rc_lock);
+}
 
-    nand_write(target_ppa, buffer, spare);
-    l2p_table[lba] = target_ppa;
-    current_page_index++;
+static void rc_invalidate(uint32_t lba) {
+    if (__atomic_load_n(&rc_slot[lba], __ATOMIC_SEQ_CST) < 0) return;
+    pthread_mutex_lock(&rc_lock);
+    int s = rc_slot[lba];
+    if (s >= 0) {
+        __atomic_store_n(&rc_slot[lba], -1, __ATOMIC_RELEASE);
+        rc_lba[s] = 0xFFFFFFFF;
+        rc_ref[s] = 0;
+    }
+    pthread_mutex_unlock(&rc_lock);
+}
+
+static void rc_release(void) {
+    free(rc_data);
+    free(rc_lba);
+    free(rc_ref);
+    free(rc_slot);
+    rc_data = NULL;
+    rc_lba = NULL;
+    rc_ref = NULL;
+    rc_slot = NULL;
+    rc_pages = rc_hand = 0;
+}
+
+int ftl_set_read_cache(int pages) {
+    if (pages < 0) return -1;
+    rc_release();
+    if (pages == 0) return 0;
+
+    rc_data = (uint8_t *)malloc((size_t)pages * NAND_PAGE_SIZE);
+    rc_lba = (uint32_t *)malloc(sizeof(uint32_t) * pages);
+    rc_ref = (uint8_t *)calloc(pages, 1);
+    rc_slot = (int *)malloc(sizeof(int) * LOGICAL_PAGES_COUNT);
+    if (!rc_data || !rc_lba || !rc_ref || !rc_slot) {
+        rc_release();
+        return -1;
+    }
+    memset(rc_lba, 0xFF, sizeof(uint32_t) * pages);
+    memset(rc_slot, 0xFF, sizeof(int) * LOGICAL_PAGES_COUNT);
+    rc_pages = pages;
+    rc_hits = rc_misses = 0;
+    return 0;
+}
+
+static void map_lock_acquire(void) {
+    if (map_serial) pthread_mutex_lock(&map_lock);
+}
+
+static void map_lock_release(void) {
+    if (map_serial) pthread_mutex_unlock(&map_lock);
+}
+
+// translation page t를 읽음 (아직 없으면 전부 unmapped)
+static void map_read_page(int t, uint32_t *entries) {
+    if (gtd[t] == 0xFFFFFFFF) {
+        memset(entries, 0xFF, NAND_PAGE_SIZE);
+        return;
+    }
+    nand_read(gtd[t], (uint8_t *)entries, NULL);
+    map_reads++;
+}
+
+// translation page를 쓸 page: die를 돌아가며 map block에 append (map_lock 필요)
+// host와 같이 GC 예약분은 남겨 두고, 어디에도 없을 때만 예약분을 씀
+// GC 도중에도 불리므로 여기서는 GC를 하지 않음
+static int map_alloc_page(uint32_t *ppa) {
+    for (int reserve = GC_RESERVED_BLOCKS; reserve >= 0; reserve -= GC_RESERVED_BLOCKS) {
+        for (int tries = 0; tries < NAND_DIES; tries++) {
+            int die = map_die++ % NAND_DIES;
+            die_info_t *d = &die_table[die];
+
+            if (d->map_page >= PAGES_PER_BLOCK) {
+                if (d->free_count <= reserve) continue;
+                if (d->map_block != -1) ftl_block_close(d->map_block);
+                d->map_block = free_pool_pop(die);
+                d->map_page = 0;
+            }
+            *ppa = d->map_block * PAGES_PER_BLOCK + d->map_page;
+            d->map_page++;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// translation page t를 새 위치에 program 하고 GTD 갱신, 이전 위치는 invalid
+static int map_program(int t, const uint32_t *entries) {
+    uint8_t spare[NAND_MAX_OOB_SIZE];
+    uint32_t tag = MAP_OOB_TAG | (uint32_t)t;
+    uint32_t ppa;
+
+    for (;;) {
+        if (map_alloc_page(&ppa) != 0) {
+            printf("[Error] No free page for translation page %d\n", t);
+            return -1;
+        }
+        oob_fill(spare, tag);
+        int ret = nand_write(ppa, (const uint8_t *)entries, spare);
+        if (ret == NAND_SUCCESS) break;
+        // 실패한 map block은 은퇴, 다음 alloc이 새 block을 엶
+        ftl_retire_append(ppa, &die_table[NAND_BLOCK_DIE(PPA_BLOCK(ppa))].map_page, ret);
+    }
+    map_writes++;
+    valid_set(ppa, tag);
+    if (gtd[t] != 0xFFFFFFFF) ftl_invalidate(gtd[t]);
+    gtd[t] = ppa;
+    return 0;
+}
+
+static int cmt_find(uint32_t lba) {
+    int s = cmt_head[lba & cmt_mask];
+    while (s >= 0 && cmt_lba[s] != lba) s = cmt_next[s];
+    return s;
+}
+
+static void cmt_unlink(int s) {
+    int *link = &cmt_head[cmt_lba[s] & cmt_mask];
+    while (*link != s) link = &cmt_next[*link];
+    *link = cmt_next[s];
+}
+
+// translation page t에 속한 dirty entry를 모두 반영해서 다시 씀 (batch update)
+static int map_writeback(int t) {
+    uint32_t *entries = flush_entries;
+    int *slots = flush_slots;
+    int n = 0;
+
+    map_read_page(t, entries);
+    for (int i = 0; i < MAP_ENTRIES; i++) {
+        uint32_t lba = (uint32_t)t * MAP_ENTRIES + i;
+        if (lba >= LOGICAL_PAGES_COUNT) break;
+        int s = cmt_find(lba);
+        if (s < 0 || !(cmt_flags[s] & CMT_DIRTY)) continue;
+        entries[i] = cmt_ppa[s];
+        slots[n++] = s;
+    }
+    if (map_program(t, entries) != 0) return -1;
+    for (int i = 0; i < n; i++) cmt_flags[slots[i]] &= ~CMT_DIRTY;
+    return 0;
+}
+
+// CLOCK으로 비울 slot을 고름, dirty면 translation page에 반영 후 (-1 = 비울 수 있는 slot 없음)
+static int cmt_evict(void) {
+    for (int scanned = 0; scanned < 2 * cmt_size + 1; scanned++) {
+        int s = cmt_hand;
+        cmt_hand = (cmt_hand + 1) % cmt_size;
+        if (cmt_flags[s] & CMT_REF) {
+            cmt_flags[s] &= ~CMT_REF;
+            continue;
+        }
+        if ((cmt_flags[s] & CMT_DIRTY) && map_writeback(cmt_lba[s] / MAP_ENTRIES) != 0) continue;
+        cmt_unlink(s);
+        return s;
+    }
+    return -1;
+}
+
+// lba의 CMT slot, 없으면 translation page에서 읽어 올림
+// 반환 -1 = CMT에 자리를 못 만듦 (*ppa만 채움)
+static int cmt_load(uint32_t lba, uint32_t *ppa) {
+    uint32_t *entries = map_entries;
+    int s = cmt_find(lba);
+    if (s >= 0) {
+        cmt_hits++;
+        cmt_flags[s] |= CMT_REF;
+        *ppa = cmt_ppa[s];
+        return s;
+    }
+
+    cmt_misses++;
+    // 자리를 먼저 비움: 내보낸 dirty entry는 방금 읽을 entry와 상관없음 (miss이므로)
+    s = cmt_used < cmt_size ? cmt_used++ : cmt_evict();
+    map_read_page(lba / MAP_ENTRIES, entries);
+    *ppa = entries[lba % MAP_ENTRIES];
+    if (s < 0) return -1;
+
+    cmt_lba[s] = lba;
+    cmt_ppa[s] = *ppa;
+    cmt_flags[s] = 0;       // 다시 참조되어야 reference (read cache와 같음)
+    cmt_next[s] = cmt_head[lba & cmt_mask];
+    cmt_head[lba & cmt_mask] = s;
+    return s;
+}
+
+// 이전 ppa 반환 (map_lock 필요)
+static uint32_t cmt_set(uint32_t lba, uint32_t ppa) {
+    uint32_t old;
+    int s = cmt_load(lba, &old);
+    if (s < 0) {
+        printf("[Error] CMT full, mapping of LBA %u lost\n", lba);
+        return old;
+    }
+    if (old == ppa) return old;     // 이미 unmapped인 LBA의 trim: translation page를 다시 쓸 필요 없음
+    cmt_ppa[s] = ppa;
+    cmt_flags[s] |= CMT_DIRTY;
+    return old;
+}
+
+// flat이 아니면 map_lock 필요
+static uint32_t l2p_get(uint32_t lba) {
+    uint32_t ppa;
+    if (ext_on) return extent_map_get(&ext_map, lba);
+    if (!cmt_size) return __atomic_load_n(&l2p_table[lba], __ATOMIC_SEQ_CST);
+    cmt_load(lba, &ppa);
+    return ppa;
+}
+
+// 이전 ppa 반환 (flat이 아니면 map_lock 필요)
+static uint32_t l2p_set(uint32_t lba, uint32_t ppa) {
+    if (cmt_size) return cmt_set(lba, ppa);
+    if (!ext_on) return __atomic_exchange_n(&l2p_table[lba], ppa, __ATOMIC_SEQ_CST);
+
+    uint32_t old = extent_map_get(&ext_map, lba);
+    if (extent_map_set(&ext_map, lba, ppa) != 0) {
+        printf("[Error] Extent map out of memory, mapping of LBA %u lost\n", lba);
+    }
+    return old;
+}
+
+static void cmt_release(void) {
+    free(cmt_lba);
+    free(cmt_ppa);
+    free(cmt_flags);
+    free(cmt_head);
+    free(cmt_next);
+    cmt_lba = cmt_ppa = NULL;
+    cmt_flags = NULL;
+    cmt_head = cmt_next = NULL;
+    cmt_size = cmt_used = cmt_hand = 0;
+}
+
+// 전체 L2P를 flat table로 모으고 translation page / map block은 GC 대상으로 돌림
+static uint32_t *map_collect(void) {
+    uint32_t *entries = map_entries;
+    uint32_t *flat = (uint32_t *)malloc(sizeof(uint32_t) * LOGICAL_PAGES_COUNT);
+    if (!flat) return NULL;
+
+    for (int t = 0; t < MAP_PAGES; t++) {
+        int n = LOGICAL_PAGES_COUNT - t * MAP_ENTRIES;
+        map_read_page(t, entries);
+        memcpy(flat + t * MAP_ENTRIES, entries, sizeof(uint32_t) * (n < MAP_ENTRIES ? n : MAP_ENTRIES));
+        if (gtd[t] != 0xFFFFFFFF) ftl_invalidate(gtd[t]);
+        gtd[t] = 0xFFFFFFFF;
+    }
+    for (int s = 0; s < cmt_used; s++) flat[cmt_lba[s]] = cmt_ppa[s];
+    for (int d = 0; d < NAND_DIES; d++) {
+        die_info_t *die = &die_table[d];
+        if (die->map_block == -1) continue;
+        ftl_block_close(die->map_block);
+        die->map_block = -1;
+        die->map_page = PAGES_PER_BLOCK;
+    }
+    return flat;
+}
+
+// 현재 mapping을 flat L2P로 되돌림 (I/O가 없을 때만)
+static int map_flatten(void) {
+    uint32_t *flat;
+
+    if (cmt_size) {
+        flat = map_collect();
+        if (!flat) return -1;
+        cmt_release();
+        l2p_table = flat;
+    } else if (ext_on) {
+        flat = (uint32_t *)malloc(sizeof(uint32_t) * LOGICAL_PAGES_COUNT);
+        if (!flat) return -1;
+        for (uint32_t lba = 0; lba < LOGICAL_PAGES_COUNT; lba++) flat[lba] = extent_map_get(&ext_map, lba);
+        extent_map_free(&ext_map);
+        ext_on = 0;
+        l2p_table = flat;
+    }
+    map_serial = 0;
+    return 0;
+}
+
+int ftl_set_extent_map(int on) {
+    if (map_flatten() != 0) return -1;
+    if (!on) return 0;
+
+    if (extent_map_init(&ext_map, LOGICAL_PAGES_COUNT) != 0) return -1;
+    for (uint32_t lba = 0; lba < LOGICAL_PAGES_COUNT; lba++) {
+        if (l2p_table[lba] == 0xFFFFFFFF) continue;
+        if (extent_map_set(&ext_map, lba, l2p_table[lba]) != 0) {
+            extent_map_free(&ext_map);
+            return -1;
+        }
+    }
+    free(l2p_table);
+    l2p_table = NULL;
+    ext_on = map_serial = 1;
+    return 0;
+}
+
+int ftl_set_map_cache(int entries) {
+    uint32_t *page = map_entries;
+    if (entries < 0 || map_flatten() != 0) return -1;
+    if (entries == 0) return 0;
+    uint32_t *flat = l2p_table;
+
+    uint32_t buckets = 1;
+    while (buckets < (uint32_t)entries) buckets <<= 1;
+    cmt_lba = (uint32_t *)malloc(sizeof(uint32_t) * entries);
+    cmt_ppa = (uint32_t *)malloc(sizeof(uint32_t) * entries);
+    cmt_flags = (uint8_t *)calloc(entries, 1);
+    cmt_next = (int *)malloc(sizeof(int) * entries);
+    cmt_head = (int *)malloc(sizeof(int) * buckets);
+    if (!cmt_lba || !cmt_ppa || !cmt_flags || !cmt_next || !cmt_head) {
+        cmt_release();
+        return -1;
+    }
+    memset(cmt_head, 0xFF, sizeof(int) * buckets);
+    cmt_mask = buckets - 1;
+    cmt_size = entries;
+    map_serial = 1;
+
+    // 기존 mapping을 translation page로 내림 (전부 unmapped인 page는 만들지 않음)
+    for (int t = 0; t < MAP_PAGES; t++) {
+        int n = LOGICAL_PAGES_COUNT - t * MAP_ENTRIES, used = 0;
+        if (n > MAP_ENTRIES) n = MAP_ENTRIES;
+        memset(page, 0xFF, NAND_PAGE_SIZE);
+        memcpy(page, flat + t * MAP_ENTRIES, sizeof(uint32_t) * n);
+        for (int i = 0; i < n && !used; i++) used = page[i] != 0xFFFFFFFF;
+        if (used && map_program(t, page) != 0) {
+            // 되돌림: 이미 쓴 translation page는 다음 전환 / GC에서 정리됨
+            for (int u = 0; u < t; u++) {
+                if (gtd[u] != 0xFFFFFFFF) ftl_invalidate(gtd[u]);
+                gtd[u] = 0xFFFFFFFF;
+            }
+            cmt_release();
+            map_serial = 0;
+            return -1;
+        }
+    }
+    free(flat);
+    l2p_table = NULL;
+    printf("[FTL] DFTL: %d cached entries, %d translation pages\n", entries, MAP_PAGES);
+    return 0;
+}
+
+// host write page 수를 셈, 분류가 켜져 있으면 logical 용량만큼 쓸 때마다 counter 감쇠
+static void host_written(int count) {
+    uint64_t h = __atomic_add_fetch(&host_pages, (uint64_t)count, __ATOMIC_RELAXED);
+    if (heat && h / LOGICAL_PAGES_COUNT != (h - count) / LOGICAL_PAGES_COUNT) heat_decay();
+}
+
+int ftl_write(uint32_t lba, const uint8_t *buffer) {
+    int ret = 0;
+    if (lba >= LOGICAL_PAGES_COUNT) return -1;
+    uint64_t start = nand_get_time();
+    int stream = heat && heat_touch(lba) ? FTL_STREAM_HOT : FTL_STREAM_COLD;
+    host_written(1);
+    // buffer가 NAND로 못 내보내는 경우 (공간 없음)는 바로 써서 System Full을 알림
+    if (!wb_pages || wb_write(lba, buffer, stream) != 0) {
+        if (ftl_program_run(&lba, 1, buffer, stream) != 1) ret = -1;
+    }
+    lat_record(FTL_OP_WRITE, start);
+    return ret;
+}
+
+// 연속 burst는 buffer를 거치지 않고 바로 stripe (이미 page 단위 batch)
+// stream < 0 = 분류: hot page가 절반 이상이면 hot (분류 off면 stream 0)
+static int write_run(uint32_t lba, int count, const uint8_t *buffer, int stream) {
+    int hot = 0, done = 0;
+    if (count <= 0 || lba >= LOGICAL_PAGES_COUNT || count > (int)(LOGICAL_PAGES_COUNT - lba)) return -1;
+    uint64_t start = nand_get_time();
+    for (int i = 0; heat && i < count; i++) hot += heat_touch(lba + i);
+    if (stream < 0 || stream >= FTL_STREAMS) stream = hot * 2 >= count ? FTL_STREAM_HOT : FTL_STREAM_COLD;
+    host_written(count);
+    if (wb_pages) wb_drop(lba, count);
+
+    // slot 하나로 lbas와 OOB를 같이 씀 (ftl_program_run을 거치면 slot을 두 번 빌리게 됨)
+    ftl_scratch_t *sc = scratch_get();
+    while (done < count) {
+        int run = count - done;
+        if (run > PAGES_PER_BLOCK) run = PAGES_PER_BLOCK;
+        for (int i = 0; i < run; i++) sc->lbas[i] = lba + done + i;
+        int ret = program_run(sc, sc->lbas, run, buffer + (size_t)done * NAND_PAGE_SIZE, stream);
+        done += ret;
+        if (ret != run) break;
+    }
+    scratch_put(sc);
+    lat_record(FTL_OP_WRITE, start);
+    return done == count ? 0 : -1;
+}
+
+int ftl_write_multi(uint32_t lba, int count, const uint8_t *buffer) {
+    return write_run(lba, count, buffer, -1);
+}
+
+int ftl_write_stream(uint32_t lba, int count, const uint8_t *buffer, int stream) {
+    return write_run(lba, count, buffer, stream);
+}
+
+// mapping을 지우고 이전 page를 invalid로: valid bit가 내려가므로 copy-back 대상에서 빠짐
+// (NAND OOB는 다시 쓸 수 없으므로 validity는 DRAM의 valid bitmap / invalid_page_count 기준)
+void ftl_trim(uint32_t lba, int count) {
+    uint64_t trimmed = 0;
+    if (count <= 0 || lba >= LOGICAL_PAGES_COUNT || count > (int)(LOGICAL_PAGES_COUNT - lba)) return;
+    // buffer에 남은 사본이 나중에 flush 되어 되살아나지 않도록 먼저 버림
+    if (wb_pages) wb_drop(lba, count);
+
+    map_lock_acquire();
+    for (uint32_t l = lba; l < lba + (uint32_t)count; l++) {
+        if (ftl_map(l, 0xFFFFFFFF) != 0xFFFFFFFF) trimmed++;
+    }
+    map_lock_release();
+    __atomic_fetch_add(&trim_pages, trimmed, __ATOMIC_RELAXED);
+}
+
+// read 쪽: counter 하나 올리고 내리는 것이 전부 (wait-free)
+static uint64_t *epoch_enter(void) {
+    if (epoch_stripe < 0) {
+        epoch_stripe = __atomic_fetch_add(&epoch_next_stripe, 1, __ATOMIC_RELAXED) % EPOCH_STRIPES;
+    }
+    unsigned e = __atomic_load_n(&epoch_cur, __ATOMIC_SEQ_CST) & 1;
+    uint64_t *slot = &epoch_readers[e][epoch_stripe].active;
+    __atomic_fetch_add(slot, 1, __ATOMIC_SEQ_CST);
+    return slot;
+}
+
+static void epoch_exit(uint64_t *slot) {
+    __atomic_fetch_sub(slot, 1, __ATOMIC_RELEASE);
+}
+
+// 호출 전에 바뀐 L2P의 이전 ppa를 들고 있을 수 있는 reader가 모두 끝날 때까지 대기
+// epoch을 읽은 뒤 늦게 counter를 올린 reader까지 잡기 위해 두 번 넘김
+static void epoch_synchronize(void) {
+    pthread_mutex_lock(&epoch_lock);
+    for (int flip = 0; flip < 2; flip++) {
+        unsigned old = __atomic_fetch_add(&epoch_cur, 1, __ATOMIC_SEQ_CST) & 1;
+        for (int i = 0; i < EPOCH_STRIPES; i++) {
+            while (__atomic_load_n(&epoch_readers[old][i].active, __ATOMIC_SEQ_CST) != 0) sched_yield();
+        }
+    }
+    pthread_mutex_unlock(&epoch_lock);
 }
 
 void ftl_read(uint32_t lba, uint8_t *buffer) {
     if (lba >= LOGICAL_PAGES_COUNT) return;
-    uint32_t ppa = l2p_table[lba];
+    uint64_t start = nand_get_time();
+    if ((wb_pages && wb_read(lba, buffer)) || (rc_pages && rc_lookup(lba, buffer))) {
+        lat_record(FTL_OP_READ, start);
+        return;
+    }
+
+    // epoch 안에서 본 ppa는 relocation 되더라도 read가 끝날 때까지 erase 되지 않음
+    // DFTL이면 map_lock을 먼저 (GC가 map_lock을 잡은 채 epoch을 기다리므로)
+    map_lock_acquire();
+    uint64_t *slot = epoch_enter();
+    uint32_t ppa = l2p_get(lba);
     if (ppa == 0xFFFFFFFF) memset(buffer, 0xFF, NAND_PAGE_SIZE);
     else nand_read(ppa, buffer, NULL);
+    // fill도 epoch 안에서: 그 사이 erase 후 재사용된 ppa가 L2P 검사를 통과하지 않게
+    if (rc_pages && ppa != 0xFFFFFFFF) rc_fill(lba, ppa, buffer);
+    epoch_exit(slot);
+    map_lock_release();
+    lat_record(FTL_OP_READ, start);
+}
+
+// ppa가 속한 die의 lock 필요
+static void ftl_invalidate(uint32_t ppa) {
+    int block = PPA_BLOCK(ppa);
+    valid_clear(ppa);
+    block_table[block].invalid_page_count++;
+    block_table[block].mtime = gc_now();
+    victim_index_inc(&die_table[NAND_BLOCK_DIE(block)].victim_idx, block);
+}
+
+// GC copy-back 목적지: 같은 die의 GC block, wear leveling victim이면 wl block (die 내부 copy-back은 bus transfer 없음)
+// 예약 pool에서만 꺼내므로 GC를 다시 부르지 않음, GC block은 die lock 아래에서만 씀
+static int ftl_alloc_page(int die, int wl, uint32_t *ppa) {
+    die_info_t *d = &die_table[die];
+    int *block = wl ? &d->wl_block : &d->gc_block;
+    int *page = wl ? &d->wl_page : &d->gc_page;
+
+    if (*page >= PAGES_PER_BLOCK) {
+        int next = ftl_get_free_block(die, 1);
+        if (next == -1) return -1;
+        if (*block != -1) ftl_block_close(*block);
+        *block = next;
+        *page = 0;
+    }
+    *ppa = *block * PAGES_PER_BLOCK + *page;
+    (*page)++;
+    return 0;
 }
 
-static void ftl_gc(void) {
-    uint8_t data[NAND_PAGE_SIZE], oob[NAND_OOB_SIZE];
-    uint32_t lba;
-    int victim = ftl_find_victim_block();
-    if (victim == -1) return;
+static uint64_t wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// static wear leveling: die 안의 erase 횟수 차가 wl_spread를 넘으면 가장 덜 닳은 closed block을 victim으로
+// 그런 block에는 오래 안 바뀐 cold data가 있으므로 옮겨서 block을 hot data가 쓰게 함 (die lock 필요)
+static int wl_pick(int die) {
+    die_info_t *d = &die_table[die];
+    int best = -1;
+    uint32_t min = UINT32_MAX;
+
+    if (!wl_spread || d->wl_skip > 0) return -1;
+    d->wl_skip = WL_INTERVAL;
+    for (int b = die; b < BLOCKS_PER_CHIP; b += NAND_DIES) {
+        if (!victim_index_contains(&d->victim_idx, b) || nand_get_erase_count(b) >= min) continue;
+        min = nand_get_erase_count(b);
+        best = b;
+    }
+    if (best == -1 || d->max_erase - min <= (uint32_t)wl_spread) return -1;
+    __atomic_fetch_add(&wl_count, 1, __ATOMIC_RELAXED);
+    return best;
+}
+
+// GC를 최대 max_pages 만큼 copy-back 하면서 진행 (victim 없으면 새로 고름), die lock 필요
+// victim을 가리키는 L2P는 이 lock 없이는 바뀌지 않으므로 valid bit / P2L을 그대로 믿고 갱신
+// 반환: 1 = victim erase 완료 (reclaimed = 확보한 page 수), 0 = 진행 중, -1 = 후보 없음 / 실패
+static int ftl_gc_copy(int die, int max_pages, int *reclaimed) {
+    die_info_t *d = &die_table[die];
 
-    for (int i=0; i<PAGES_PER_BLOCK; i++) {
-        uint32_t ppa = victim * PAGES_PER_BLOCK + i;
-        nand_read(ppa, NULL, oob);
-        memcpy(&lba, oob, sizeof(uint32_t));
-        if (lba < LOGICAL_PAGES_COUNT && l2p_table[lba] == ppa) {
-            nand_read(ppa, data, NULL);
-            ftl_write(lba, data);
+    if (d->gc_victim == -1) {
+        int victim = wl_pick(die);
+        d->gc_wl = victim != -1;
+        if (victim == -1) victim = ftl_find_victim_block(die);
+        if (victim == -1) return -1;
+        victim_index_remove(&d->victim_idx, victim);
+        d->gc_bad = nand_is_bad_block(victim);
+        d->gc_victim = victim;
+        d->gc_scan = 0;
+    }
+
+    // valid bit만 ctz로 훑음: 단계 사이에 host write로 무효화된 page는 bit가 이미 내려가 있음
+    int victim = d->gc_victim;
+    int copied = 0;
+    while (d->gc_scan < PAGES_PER_BLOCK && copied < max_pages) {
+        int page = valid_next(victim, d->gc_scan);
+        if (page < 0) {
+            d->gc_scan = PAGES_PER_BLOCK;
+            break;
+        }
+        uint32_t src = victim * PAGES_PER_BLOCK + page;
+        uint32_t lba = p2l[src], dst;
+        int tpage = (lba & MAP_OOB_TAG) != 0;   // translation page는 GTD를 갱신
+        d->gc_scan = page;
+
+        if (ftl_alloc_page(die, d->gc_wl, &dst) != 0) {
+            // 옮기지 못한 page가 남았으므로 erase하지 않고 후보로 되돌림
+            printf("[Error] GC reserve exhausted on die %d\n", die);
+            victim_index_insert(&d->victim_idx, victim, block_table[victim].invalid_page_count);
+            d->gc_victim = -1;
+            return -1;
+        }
+        uint64_t t0 = wall_ns();
+        int ret = nand_copyback(src, dst, NULL);
+        __atomic_fetch_add(&gc_nand_ns, wall_ns() - t0, __ATOMIC_RELAXED);
+        if (ret != NAND_SUCCESS) {
+            // 목적지 block을 은퇴시키고 같은 page를 새 목적지로 다시
+            ftl_retire_append(dst, d->gc_wl ? &d->wl_page : &d->gc_page, ret);
+            continue;
         }
+        valid_set(dst, lba);
+        if (tpage) gtd[lba & ~MAP_OOB_TAG] = dst;
+        else l2p_set(lba, dst);
+        ftl_invalidate(src);
+        d->gc_scan++;
+        copied++;
+        __atomic_fetch_add(&gc_pages, 1, __ATOMIC_RELAXED);
     }
+    if (d->gc_scan < PAGES_PER_BLOCK) return 0;
+
+    // copy-back으로 무효화된 page를 빼면 victim이 원래 가지고 있던 invalid page 수
+    *reclaimed = block_table[victim].invalid_page_count - copied;
+    // victim의 옛 ppa를 읽고 있을 수 있는 host read가 끝난 뒤 erase
+    epoch_synchronize();
+    uint64_t t0 = wall_ns();
     nand_erase(victim);
+    __atomic_fetch_add(&gc_nand_ns, wall_ns() - t0, __ATOMIC_RELAXED);
+    if (nand_get_erase_count(victim) > d->max_erase) d->max_erase = nand_get_erase_count(victim);
+    if (d->wl_skip > 0) d->wl_skip--;
     block_table[victim].invalid_page_count = 0;
-    block_table[victim].is_free = 1;
+    block_table[victim].programmed = 0;
+    // 은퇴한 block은 data만 비우고 다시 쓰지 않음
+    if (d->gc_bad) *reclaimed = 0;
+    else free_pool_push(victim);
+    d->gc_victim = -1;
+    __atomic_fetch_add(&gc_count, 1, __ATOMIC_RELAXED);
+    return 1;
 }
 
-static int ftl_find_victim_block(void) {
-    int victim = -1, max = -1;
-    for (int i=0; i<BLOCKS_PER_CHIP; i++) {
-        if (i == current_block_index || block_table[i].is_free || nand_is_bad_block(i)) continue;
-        if (block_table[i].invalid_page_count > max) {
-            max = block_table[i].invalid_page_count;
-            victim = i;
+// ftl_gc_copy + 걸린 시간 집계
+static int ftl_gc_run(int die, int max_pages, int *reclaimed) {
+    uint64_t t0 = wall_ns();
+    int ret = ftl_gc_copy(die, max_pages, reclaimed);
+    __atomic_fetch_add(&gc_ns, wall_ns() - t0, __ATOMIC_RELAXED);
+    return ret;
+}
+
+// foreground GC: 진행 중인 victim이 있으면 마저 끝내고, 없으면 새 victim 하나를 회수 (die lock 필요)
+// wear leveling victim과 은퇴한 bad block은 공간이 거의 안 생기므로 이어서 일반 victim도 회수
+// 새로 확보한 page 수 반환 (0 = 진전 없음)
+static int ftl_gc(int die) {
+    int reclaimed = 0, ret;
+    do {
+        while ((ret = ftl_gc_run(die, PAGES_PER_BLOCK, &reclaimed)) == 0) ;
+    } while (ret == 1 && (die_table[die].gc_wl || die_table[die].gc_bad));
+    return ret == 1 ? reclaimed : 0;
+}
+
+static int ftl_bg_gc_needed(int die) {
+    return die_table[die].gc_victim != -1 || die_table[die].free_count < gc_high_wm;
+}
+
+// die lock을 잡고 background GC 한 단계, ftl_gc_run 반환값 (-2 = 할 일 없음)
+static int ftl_bg_gc_run(int die, int max_pages) {
+    die_info_t *d = &die_table[die];
+    int reclaimed, ret = -2;
+
+    map_lock_acquire();
+    pthread_mutex_lock(&d->lock);
+    if (ftl_bg_gc_needed(die)) ret = ftl_gc_run(die, max_pages, &reclaimed);
+    pthread_mutex_unlock(&d->lock);
+    map_lock_release();
+    if (ret == 1) __atomic_fetch_add(&bg_gc_count, 1, __ATOMIC_RELAXED);
+    return ret;
+}
+
+int ftl_gc_step(int max_pages) {
+    static unsigned bg_die = 0;
+
+    for (int tries = 0; tries < NAND_DIES; tries++) {
+        int die = __atomic_fetch_add(&bg_die, 1, __ATOMIC_RELAXED) % NAND_DIES;
+        if (ftl_bg_gc_run(die, max_pages) >= 0) return 1;
+    }
+    return 0;
+}
+
+void ftl_idle(uint64_t idle_ns) {
+    uint64_t end = nand_get_time() + idle_ns;
+
+    // idle 구간 안에 끝날 수 있는 die에만 GC를 올림
+    for (int die = 0; die < NAND_DIES; die++) {
+        while (nand_get_die_idle_time(die) < end) {
+            if (ftl_bg_gc_run(die, BG_GC_STEP_PAGES) < 0) break;
         }
     }
-    return (max < 0) ? -1 : victim;
+    nand_wait_until(end);
 }
 
-static int ftl_get_free_block(void) {
-    for(int k=0; k<2; k++) {
-        for(int i=0; i<BLOCKS_PER_CHIP; i++) {
-            if(block_table[i].is_free && !nand_is_bad_block(i)) {
-                block_table[i].is_free = 0; return i;
-            }
+// host I/O와 동시에 도는 GC thread: 할 일이 없으면 잠깐 쉼
+static void *ftl_bg_gc_main(void *arg) {
+    (void)arg;
+    while (__atomic_load_n(&bg_gc_running, __ATOMIC_ACQUIRE)) {
+        if (!ftl_gc_step(BG_GC_STEP_PAGES)) usleep(100);
+    }
+    return NULL;
+}
+
+int ftl_bg_gc_start(void) {
+    if (bg_gc_running) return 0;
+    bg_gc_running = 1;
+    if (pthread_create(&bg_gc_thread, NULL, ftl_bg_gc_main, NULL) != 0) {
+        bg_gc_running = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void ftl_bg_gc_stop(void) {
+    if (!bg_gc_running) return;
+    __atomic_store_n(&bg_gc_running, 0, __ATOMIC_RELEASE);
+    pthread_join(bg_gc_thread, NULL);
+}
+
+void ftl_set_gc_watermarks(int low, int high) {
+    gc_low_wm = low < GC_RESERVED_BLOCKS ? GC_RESERVED_BLOCKS : low;
+    gc_high_wm = high;
+}
+
+int ftl_set_gc_policy(ftl_gc_policy_t policy, int param) {
+    static const int defaults[FTL_GC_POLICY_COUNT] = { 0, GC_CB_CANDIDATES, GC_D_CHOICES, GC_WINDOW };
+    if ((unsigned)policy >= FTL_GC_POLICY_COUNT || param < 0) return -1;
+    if (param == 0) param = defaults[policy];
+    gc_policy = policy;
+    gc_policy_param = param < BLOCKS_PER_DIE ? param : BLOCKS_PER_DIE;
+    return 0;
+}
+
+// 다 쓴 block을 GC 후보로 (die lock 필요)
+static void ftl_block_close(int block) {
+    block_info_t *b = &block_table[block];
+    b->mtime = gc_now();
+    victim_index_insert(&die_table[NAND_BLOCK_DIE(block)].victim_idx, block, b->invalid_page_count);
+}
+
+// GC victim 정책: die lock 아래에서 die의 closed block (victim index에 있는 것) 중 하나, 없으면 -1
+// die의 block은 die, die + NAND_DIES, ... (NAND_BLOCK_DIE)
+typedef int (*gc_pick_t)(int die);
+
+static int pick_greedy(int die) {
+    return victim_index_pick(&die_table[die].victim_idx);
+}
+
+static double cost_benefit(int block, uint64_t now) {
+    int invalid = block_table[block].invalid_page_count;
+    return (double)(now - block_table[block].mtime + 1) * invalid / (2.0 * (PAGES_PER_BLOCK - invalid));
+}
+
+// age * (1 - u) / 2u (u = valid 비율) = age * invalid / (2 * valid) 최대
+// 오래 안 바뀐 cold block은 invalid가 적어도 뽑혀서 hot block의 invalid가 더 쌓일 시간을 벎
+// 전체를 훑지 않고 점수가 높을 만한 후보만 봄: invalid가 많은 param 개 (bucket 위에서부터)
+// + 가장 오래전에 닫힌 param 개 (FIFO 앞, 대개 age가 큰 cold block)
+static int pick_cost_benefit(int die) {
+    victim_index_t *vi = &die_table[die].victim_idx;
+    int best = pick_greedy(die);
+    // 전부 invalid면 옮길 것이 없으므로 점수를 볼 필요 없음
+    if (best == -1 || block_table[best].invalid_page_count >= PAGES_PER_BLOCK) return best;
+
+    uint64_t now = gc_now();
+    double best_score = cost_benefit(best, now);
+    int b = victim_index_next(vi, best);
+    for (int i = 1; i < gc_policy_param && b != -1; i++, b = victim_index_next(vi, b)) {
+        double score = cost_benefit(b, now);
+        if (score > best_score) {
+            best_score = score;
+            best = b;
         }
-        if(k==0) ftl_gc();
     }
-    return -1;
+    b = victim_index_oldest(vi);
+    for (int i = 0; i < gc_policy_param && b != -1; i++, b = victim_index_newer(vi, b)) {
+        double score = cost_benefit(b, now);
+        if (score > best_score) {
+            best_score = score;
+            best = b;
+        }
+    }
+    return best;
+}
+
+// 무작위 d 개 closed block 중 greedy (표본이 안 잡히면 전체 greedy)
+static int pick_d_choices(int die) {
+    die_info_t *d = &die_table[die];
+    int best = -1;
+    for (int found = 0, tries = 0; found < gc_policy_param && tries < 4 * gc_policy_param; tries++) {
+        int b = die + (int)(rand_r(&d->gc_seed) % BLOCKS_PER_DIE) * NAND_DIES;
+        if (!victim_index_contains(&d->victim_idx, b)) continue;
+        found++;
+        if (best == -1 || block_table[b].invalid_page_count > block_table[best].invalid_page_count) best = b;
+    }
+    return best != -1 ? best : pick_greedy(die);
+}
+
+// 가장 오래전에 닫힌 w 개 block (victim index의 FIFO 앞) 안에서 greedy
+static int pick_windowed(int die) {
+    victim_index_t *vi = &die_table[die].victim_idx;
+    int best = -1, b = victim_index_oldest(vi);
+
+    for (int i = 0; i < gc_policy_param && b != -1; i++, b = victim_index_newer(vi, b)) {
+        if (best == -1 || block_table[b].invalid_page_count > block_table[best].invalid_page_count) best = b;
+    }
+    return best;
+}
+
+static const gc_pick_t gc_policies[FTL_GC_POLICY_COUNT] = {
+    [FTL_GC_GREEDY] = pick_greedy,
+    [FTL_GC_COST_BENEFIT] = pick_cost_benefit,
+    [FTL_GC_D_CHOICES] = pick_d_choices,
+    [FTL_GC_WINDOWED] = pick_windowed,
+};
+
+static int ftl_find_victim_block(int die) {
+    // 인덱스에는 closed block만 있음 (free / open / bad block 제외)
+    return gc_policies[gc_policy](die);
+}
+
+// free pool 순서: dynamic wear leveling이면 erase 횟수, 같으면 (또는 꺼져 있으면) 들어온 순서
+// pool 안의 block은 erase 되지 않으므로 key가 바뀌지 않음
+static uint64_t free_key(int block) {
+    uint64_t key = block_table[block].free_seq;
+    if (wl_dynamic) key |= (uint64_t)nand_get_erase_count(block) << 32;
+    return key;
+}
+
+static void free_heap_up(die_info_t *d, int i) {
+    int block = d->free_pool[i];
+    uint64_t key = free_key(block);
+    while (i > 0 && free_key(d->free_pool[(i - 1) / 2]) > key) {
+        d->free_pool[i] = d->free_pool[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    d->free_pool[i] = block;
+}
+
+static void free_heap_down(die_info_t *d, int i) {
+    int block = d->free_pool[i];
+    uint64_t key = free_key(block);
+    for (;;) {
+        int c = 2 * i + 1;
+        if (c >= d->free_count) break;
+        if (c + 1 < d->free_count && free_key(d->free_pool[c + 1]) < free_key(d->free_pool[c])) c++;
+        if (free_key(d->free_pool[c]) >= key) break;
+        d->free_pool[i] = d->free_pool[c];
+        i = c;
+    }
+    d->free_pool[i] = block;
+}
+
+// free pool은 die lock 아래에서만 (init 제외)
+static void free_pool_push(int block) {
+    die_info_t *d = &die_table[NAND_BLOCK_DIE(block)];
+    if (d->free_count >= BLOCKS_PER_DIE) return;
+    block_table[block].free_seq = d->free_seq++;
+    d->free_pool[d->free_count++] = block;
+    free_heap_up(d, d->free_count - 1);
+    __atomic_fetch_add(&free_total, 1, __ATOMIC_RELAXED);
+    block_table[block].is_free = 1;
+}
+
+static int free_pool_pop(int die) {
+    die_info_t *d = &die_table[die];
+    if (d->free_count == 0) return -1;
+    int block = d->free_pool[0];
+    d->free_pool[0] = d->free_pool[--d->free_count];
+    if (d->free_count > 0) free_heap_down(d, 0);
+    int total = __atomic_sub_fetch(&free_total, 1, __ATOMIC_RELAXED);
+    int min = __atomic_load_n(&free_min, __ATOMIC_RELAXED);
+    while (total < min && !__atomic_compare_exchange_n(&free_min, &min, total, 1,
+                                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) ;
+    block_table[block].is_free = 0;
+    return block;
+}
+
+int ftl_set_wear_leveling(int dynamic, int spread) {
+    if (spread < 0) return -1;
+    wl_dynamic = dynamic != 0;
+    wl_spread = spread;
+    // key가 바뀌었으므로 pool을 다시 heap으로
+    for (int die = 0; die < NAND_DIES; die++) {
+        die_info_t *d = &die_table[die];
+        for (int i = d->free_count / 2 - 1; i >= 0; i--) free_heap_down(d, i);
+    }
+    return 0;
+}
+
+// host는 예약분을 남겨두고 가져감, 부족하면 여기서 GC (GC 쪽은 예약분까지 사용), die lock 필요
+static int ftl_get_free_block(int die, int for_gc) {
+    die_info_t *d = &die_table[die];
+    int reserve = for_gc ? 0 : GC_RESERVED_BLOCKS;
+
+    // low watermark 이하면 foreground GC (emergency)
+    while (!for_gc && d->free_count <= gc_low_wm) {
+        // 전부 valid인 victim만 남으면 더 이상 공간이 생기지 않으므로 중단
+        if (ftl_gc(die) == 0) break;
+    }
+    if (d->free_count <= reserve) return -1;
+    return free_pool_pop(die);
+}
+
+void ftl_get_stats(ftl_stats_t *stats) {
+    stats->free_blocks = __atomic_load_n(&free_total, __ATOMIC_RELAXED);
+    stats->min_free_blocks = __atomic_load_n(&free_min, __ATOMIC_RELAXED);
+    stats->gc_count = __atomic_load_n(&gc_count, __ATOMIC_RELAXED);
+    stats->bg_gc_count = __atomic_load_n(&bg_gc_count, __ATOMIC_RELAXED);
+    stats->host_pages = __atomic_load_n(&host_pages, __ATOMIC_RELAXED);
+    stats->nand_pages = __atomic_load_n(&nand_pages, __ATOMIC_RELAXED);
+    stats->gc_pages = __atomic_load_n(&gc_pages, __ATOMIC_RELAXED);
+    stats->gc_ns = __atomic_load_n(&gc_ns, __ATOMIC_RELAXED);
+    stats->gc_nand_ns = __atomic_load_n(&gc_nand_ns, __ATOMIC_RELAXED);
+    stats->wl_count = __atomic_load_n(&wl_count, __ATOMIC_RELAXED);
+    stats->wb_hits = __atomic_load_n(&wb_hits, __ATOMIC_RELAXED);
+    stats->trim_pages = __atomic_load_n(&trim_pages, __ATOMIC_RELAXED);
+    stats->rc_hits = __atomic_load_n(&rc_hits, __ATOMIC_RELAXED);
+    stats->rc_misses = __atomic_load_n(&rc_misses, __ATOMIC_RELAXED);
+    map_lock_acquire();
+    stats->cmt_hits = cmt_hits;
+    stats->cmt_misses = cmt_misses;
+    stats->map_reads = map_reads;
+    stats->map_writes = map_writes;
+    stats->map_dram_bytes = ext_on ? ext_map.bytes : cmt_size ? (uint64_t)cmt_size * (3 * sizeof(uint32_t) + 1) +
+                                       (uint64_t)(cmt_mask + 1) * sizeof(int) +
+                                       (uint64_t)MAP_PAGES * sizeof(uint32_t)
+                                     : (uint64_t)LOGICAL_PAGES_COUNT * sizeof(uint32_t);
+    map_lock_release();
+}
+
+uint64_t ftl_get_latency(ftl_op_t op, double percentile) {
+    if (op < 0 || op >= FTL_OP_COUNT) return 0;
+    lat_hist_t *h = &lat_hist[op];
+    if (h->count == 0) return 0;
+
+    uint64_t target = (uint64_t)(h->count * percentile / 100.0);
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < LAT_BUCKETS; i++) {
+        seen += h->bucket[i];
+        if (seen >= target) {
+            uint64_t v = lat_bucket_upper(i);
+            return v < h->max ? v : h->max;
+        }
+    }
+    return h->max;
+}
+
+// op 별 latency 분포와 IOPS (virtual time 기준)
+static void ftl_report_latency(void) {
+    static const char *names[FTL_OP_COUNT] = { "read", "write" };
+    double elapsed = nand_get_finish_time() / 1e9;
+
+    if (!nand_timing_enabled()) return;
+    printf("[FTL] Virtual time %.3f s\n", elapsed);
+    for (int op = 0; op < FTL_OP_COUNT; op++) {
+        lat_hist_t *h = &lat_hist[op];
+        if (h->count == 0) continue;
+        printf("[FTL] %-5s %8llu ops, %9.0f IOPS, latency us: avg %.1f p50 %.1f p99 %.1f p99.9 %.1f max %.1f\n",
+               names[op], (unsigned long long)h->count, elapsed > 0 ? h->count / elapsed : 0.0,
+               h->sum / 1e3 / h->count,
+               ftl_get_latency(op, 50) / 1e3, ftl_get_latency(op, 99) / 1e3,
+               ftl_get_latency(op, 99.9) / 1e3, h->max / 1e3);
+    }
 }
 
 void ftl_exit(void) {
-    if(l2p_table) free(l2p_table);
-    if(block_table) free(block_table);
+    // background GC가 buffer / cache / stream 상태를 건드리지 않도록 가장 먼저 정지
+    ftl_bg_gc_stop();
+    ftl_flush();
+    wb_release();
+    rc_release();
+    ftl_set_hot_cold(0);
+    ftl_report_latency();
+    cmt_release();
+    if (ext_on) extent_map_free(&ext_map);
+    ext_on = map_serial = 0;
+    ftl_free_tables(NAND_DIES);
     nand_exit();
 }
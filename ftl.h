@@ -2,14 +2,106 @@
 #define FTL_H
 
 #include <stdint.h>
+#include "nand_hal.h"
 
 // 설정값 정의
-#define LOGICAL_PAGES_COUNT 60000 
+// logical 용량은 ftl_init()이 geometry의 물리 page 수와 op_percent로 정함
+// (op_percent 0 = 기본 geometry와 같은 비율, 기본 geometry면 60000)
+#define DEFAULT_LOGICAL_PAGES   60000
+extern uint32_t ftl_logical_pages;
+#define LOGICAL_PAGES_COUNT (ftl_logical_pages)
+
+typedef struct {
+    uint32_t free_blocks;       // free block pool depth
+    uint32_t min_free_blocks;   // lowest pool depth since init
+    uint64_t gc_count;          // erased victim blocks
+    uint64_t bg_gc_count;       // ... of which by background GC
+    uint64_t host_pages;        // pages written by the host
+    uint64_t nand_pages;        // host pages programmed to NAND (after the write buffer)
+    uint64_t gc_pages;          // pages relocated by GC
+    uint64_t gc_ns;             // host CPU (wall-clock) time spent in GC steps, not virtual time
+    uint64_t gc_nand_ns;        // part of gc_ns inside copy-back / erase HAL calls
+    uint64_t wl_count;          // victims picked by static wear leveling (their copies count in gc_pages)
+    uint64_t wb_hits;           // overwrites absorbed by the write buffer
+    uint64_t trim_pages;        // mapped pages dropped by ftl_trim
+    uint64_t rc_hits;           // reads served by the read cache
+    uint64_t rc_misses;         // reads that went to NAND while the cache was on
+    uint64_t cmt_hits;          // DFTL: L2P lookups served by the cached mapping table
+    uint64_t cmt_misses;        // DFTL: lookups that had to read a translation page
+    uint64_t map_reads;         // DFTL: translation page reads (misses + dirty write-back)
+    uint64_t map_writes;        // DFTL: translation page programs
+    uint64_t map_dram_bytes;    // DRAM held by the mapping table (flat L2P, CMT + GTD or extents)
+} ftl_stats_t;
+
+typedef enum {
+    FTL_OP_READ = 0,
+    FTL_OP_WRITE,
+    FTL_OP_COUNT
+} ftl_op_t;
 
 // 함수 원형 선언 (내용 구현 없음, 세미콜론 필수)
-int ftl_init(void);
+// ftl_read / ftl_write / ftl_write_multi / ftl_write_stream / ftl_trim / ftl_gc_step은 여러 thread에서 동시에 호출 가능
+// (init / exit / set_gc_watermarks는 I/O가 없을 때만)
+int ftl_init(const nand_config_t *nand_cfg);    // nand_cfg NULL = default backend
 void ftl_read(uint32_t lba, uint8_t *buffer);
-void ftl_write(uint32_t lba, const uint8_t *buffer);
+// write는 0 = ok, -1 = 범위 밖이거나 일부 page를 쓰지 못함 (공간 없음 / 모든 die에서 program 실패)
+// write buffer에 들어간 page의 program 결과는 ftl_flush()가 알림
+int ftl_write(uint32_t lba, const uint8_t *buffer);
+int ftl_write_multi(uint32_t lba, int count, const uint8_t *buffer);    // count consecutive LBAs
+// discard: count 개 LBA의 mapping을 지움 (이후 read는 0xFF), 이전 page는 invalid가 되어 GC가 옮기지 않음
+void ftl_trim(uint32_t lba, int count);
 void ftl_exit(void);
+void ftl_get_stats(ftl_stats_t *stats);
+// Background GC
+// watermark는 die 당 free block 수: free <= low 이면 host write가 foreground GC,
+// free < high 이면 ftl_gc_step() / ftl_idle()이 GC를 진행 (high <= low 이면 background GC 없음)
+void ftl_set_gc_watermarks(int low, int high);
+// GC victim 선택 정책 (default greedy, I/O가 없을 때만 바꿈)
+typedef enum {
+    FTL_GC_GREEDY = 0,      // invalid page가 가장 많은 block
+    FTL_GC_COST_BENEFIT,    // age * (1 - u) / 2u 최대 (u = valid 비율, age = 마지막 변경 후 host write 수)
+                            // 후보는 invalid가 많은 param 개 + 가장 오래전에 닫힌 param 개 (default 16)
+    FTL_GC_D_CHOICES,       // 무작위 param 개 (default 8) 중 greedy
+    FTL_GC_WINDOWED,        // 가장 오래전에 닫힌 param 개 (default 16) 중 greedy
+    FTL_GC_POLICY_COUNT
+} ftl_gc_policy_t;
+int ftl_set_gc_policy(ftl_gc_policy_t policy, int param);  // param 0 = default, -1 = 잘못된 정책
+// Wear leveling (erase 횟수는 nand_get_erase_count)
+// dynamic: free block을 erase 횟수가 적은 것부터 씀 (1 = default, 0 = FIFO)
+// spread: die 안의 최대 - 최소 erase 횟수가 이보다 크면 GC가 가장 덜 닳은 closed block의
+// cold data를 옮겨 그 block을 다시 쓰게 함 (static, 0 = off, default). I/O가 없을 때만
+int ftl_set_wear_leveling(int dynamic, int spread);
+int ftl_gc_step(int max_pages);     // copy-back 최대 max_pages, 0 = 할 일 없음
+void ftl_idle(uint64_t idle_ns);    // host idle 구간 (virtual ns) 동안 background GC
+// Write buffer
+// pages 만큼의 DRAM write-back buffer (0 = off, default), ftl_write()의 덮어쓰기를 흡수하고
+// 꽉 차면 batch로 NAND에 내보냄. ftl_write_multi()는 buffer를 거치지 않음
+int ftl_set_write_buffer(int pages);    // 이전 buffer는 flush 후 교체 (I/O가 없을 때만)
+int ftl_flush(void);                    // buffer 전체를 NAND에 기록, 0 = ok
+// Read cache
+// NAND에서 읽은 page를 LBA 기준으로 pages 만큼 보관 (0 = off, default), CLOCK 교체
+// 적중률은 ftl_get_stats()의 rc_hits / rc_misses
+int ftl_set_read_cache(int pages);      // 내용은 비우고 다시 만듦 (I/O가 없을 때만)
+// Demand-paged mapping (DFTL)
+// L2P를 NAND의 translation page에 두고 entries 개만 DRAM의 CMT에 cache (0 = 전체 L2P를 DRAM에, default)
+// 기존 mapping은 옮겨 줌 (I/O가 없을 때만). DFTL에서는 FTL 경로 전체가 lock 하나로 직렬화됨
+int ftl_set_map_cache(int entries);
+// Extent L2P
+// 연속 LBA -> 연속 PPA 구간을 (lba, ppa, len) extent 하나로 저장 (1 = on, 0 = flat, default)
+// segment 안이 조각나면 page 별 entry로 fallback. DFTL과 같이 쓸 수 없음 (켜면 다른 쪽은 꺼짐)
+int ftl_set_extent_map(int on);
+// Write streams (NVMe streams / FDP와 비슷)
+// stream 마다 die 별 host open block을 따로 두어 수명이 비슷한 data끼리 한 block에 모음 (GC block은 별도)
+// hint 없는 write는 stream 0, ftl_set_hot_cold(1)이면 LBA 별 write 빈도로 cold (0) / hot (1)을 자동으로 고름
+#define FTL_STREAMS         4
+#define FTL_STREAM_COLD     0
+#define FTL_STREAM_HOT      1
+int ftl_set_hot_cold(int on);       // 켜면 빈도 counter는 0부터 (I/O가 없을 때만)
+// ftl_write_multi + stream hint (0 ~ FTL_STREAMS-1, 범위 밖이면 hint 없음과 같음)
+int ftl_write_stream(uint32_t lba, int count, const uint8_t *buffer, int stream);
+// host I/O와 병렬로 ftl_gc_step()을 도는 thread (ftl_exit에서 정지)
+int ftl_bg_gc_start(void);
+void ftl_bg_gc_stop(void);
+uint64_t ftl_get_latency(ftl_op_t op, double percentile);    // host op latency in virtual ns (0 ~ 100)
 
 #endif
@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "ftl_async.h"
+
+#define ASYNC_MAX_WORKERS   64
+
+struct ftl_req {
+    int op;                 // ftl_op_t
+    uint32_t lba;
+    uint8_t *buffer;
+    ftl_req_cb_t cb;
+    void *arg;
+    int status;
+    int done;               // atomic
+    int next_free;          // free list link (index)
+};
+
+// 요청은 미리 할당한 pool에서 꺼내 씀: submit 경로에 malloc 없음
+// 대기 queue는 pool 크기의 ring이므로 넘치지 않음
+static ftl_req_t *req_pool = NULL;
+static int pool_size = 0;
+static int free_head = -1;
+static ftl_req_t **pending = NULL;
+static int pending_head = 0;
+static int pending_count = 0;
+
+static pthread_mutex_t async_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cv = PTHREAD_COND_INITIALIZER;      // pending에 요청이 생김
+static pthread_cond_t done_cv = PTHREAD_COND_INITIALIZER;      // 요청 완료 (ftl_req_wait)
+static pthread_t workers[ASYNC_MAX_WORKERS];
+static int nr_workers = 0;
+static int stopping = 0;
+
+static void *async_worker(void *unused) {
+    (void)unused;
+    for (;;) {
+        pthread_mutex_lock(&async_lock);
+        while (pending_count == 0 && !stopping) pthread_cond_wait(&work_cv, &async_lock);
+        if (pending_count == 0) {
+            pthread_mutex_unlock(&async_lock);
+            return NULL;
+        }
+        ftl_req_t *req = pending[pending_head];
+        pending_head = (pending_head + 1) % pool_size;
+        pending_count--;
+        pthread_mutex_unlock(&async_lock);
+
+        req->status = 0;
+        if (req->lba >= LOGICAL_PAGES_COUNT) req->status = -1;
+        else if (req->op == FTL_OP_READ) ftl_read(req->lba, req->buffer);
+        else req->status = ftl_write(req->lba, req->buffer);
+
+        if (req->cb) {
+            req->cb(req, req->status, req->arg);
+            ftl_req_release(req);
+            continue;
+        }
+        pthread_mutex_lock(&async_lock);
+        __atomic_store_n(&req->done, 1, __ATOMIC_RELEASE);
+        pthread_cond_broadcast(&done_cv);
+        pthread_mutex_unlock(&async_lock);
+    }
+}
+
+int ftl_async_init(int nworkers, int max_inflight) {
+    if (nworkers <= 0 || nworkers > ASYNC_MAX_WORKERS || max_inflight <= 0) return -1;
+
+    req_pool = (ftl_req_t *)calloc(max_inflight, sizeof(ftl_req_t));
+    pending = (ftl_req_t **)calloc(max_inflight, sizeof(ftl_req_t *));
+    if (!req_pool || !pending) {
+        free(req_pool);
+        free(pending);
+        req_pool = NULL;
+        pending = NULL;
+        return -1;
+    }
+    pool_size = max_inflight;
+    for (int i = 0; i < max_inflight; i++) req_pool[i].next_free = i + 1 < max_inflight ? i + 1 : -1;
+    free_head = 0;
+    pending_head = pending_count = 0;
+    stopping = 0;
+
+    for (nr_workers = 0; nr_workers < nworkers; nr_workers++) {
+        if (pthread_create(&workers[nr_workers], NULL, async_worker, NULL) != 0) break;
+    }
+    if (nr_workers == 0) {
+        ftl_async_exit();
+        return -1;
+    }
+    printf("[FTL] Async I/O: %d workers, %d in-flight requests\n", nr_workers, max_inflight);
+    return 0;
+}
+
+void ftl_async_exit(void) {
+    pthread_mutex_lock(&async_lock);
+    stopping = 1;
+    pthread_cond_broadcast(&work_cv);
+    pthread_mutex_unlock(&async_lock);
+    for (int i = 0; i < nr_workers; i++) pthread_join(workers[i], NULL);
+    nr_workers = 0;
+
+    free(req_pool);
+    free(pending);
+    req_pool = NULL;
+    pending = NULL;
+    pool_size = 0;
+    free_head = -1;
+}
+
+static ftl_req_t *async_submit(int op, uint32_t lba, uint8_t *buffer, ftl_req_cb_t cb, void *arg) {
+    pthread_mutex_lock(&async_lock);
+    if (free_head == -1 || stopping) {
+        pthread_mutex_unlock(&async_lock);
+        return NULL;
+    }
+    ftl_req_t *req = &req_pool[free_head];
+    free_head = req->next_free;
+
+    req->op = op;
+    req->lba = lba;
+    req->buffer = buffer;
+    req->cb = cb;
+    req->arg = arg;
+    req->done = 0;
+    pending[(pending_head + pending_count) % pool_size] = req;
+    pending_count++;
+    pthread_cond_signal(&work_cv);
+    pthread_mutex_unlock(&async_lock);
+    return req;
+}
+
+ftl_req_t *ftl_submit_read(uint32_t lba, uint8_t *buffer, ftl_req_cb_t cb, void *arg) {
+    return async_submit(FTL_OP_READ, lba, buffer, cb, arg);
+}
+
+ftl_req_t *ftl_submit_write(uint32_t lba, const uint8_t *buffer, ftl_req_cb_t cb, void *arg) {
+    // write는 buffer를 읽기만 함
+    return async_submit(FTL_OP_WRITE, lba, (uint8_t *)buffer, cb, arg);
+}
+
+int ftl_req_poll(const ftl_req_t *req) {
+    return __atomic_load_n(&req->done, __ATOMIC_ACQUIRE);
+}
+
+int ftl_req_wait(ftl_req_t *req) {
+    if (!ftl_req_poll(req)) {
+        pthread_mutex_lock(&async_lock);
+        while (!req->done) pthread_cond_wait(&done_cv, &async_lock);
+        pthread_mutex_unlock(&async_lock);
+    }
+    return req->status;
+}
+
+void ftl_req_release(ftl_req_t *req) {
+    pthread_mutex_lock(&async_lock);
+    req->next_free = free_head;
+    free_head = (int)(req - req_pool);
+    pthread_mutex_unlock(&async_lock);
+}
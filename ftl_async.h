@@ -0,0 +1,30 @@
+// ftl_async.h
+#ifndef FTL_ASYNC_H
+#define FTL_ASYNC_H
+
+#include <stdint.h>
+#include "ftl.h"
+
+// 비동기 I/O: submit은 바로 반환하고 worker thread pool이 ftl_read / ftl_write를 수행
+// 한 host thread가 여러 요청을 동시에 걸어 둘 수 있음 (최대 max_inflight)
+//
+// handle 수명
+//  - callback 없음: ftl_req_poll / ftl_req_wait로 완료 확인 후 ftl_req_release
+//  - callback 있음: 완료 시 worker thread에서 callback 호출, 반환 후 자동 해제 (wait / release 금지)
+
+typedef struct ftl_req ftl_req_t;
+typedef void (*ftl_req_cb_t)(ftl_req_t *req, int status, void *arg);
+
+int ftl_async_init(int workers, int max_inflight);     // ftl_init 이후
+void ftl_async_exit(void);                              // 남은 요청을 끝내고 worker 정지 (ftl_exit 전에)
+
+// 반환 NULL = in-flight 요청이 max_inflight 만큼 차 있음
+// buffer는 완료될 때까지 유지해야 함
+ftl_req_t *ftl_submit_read(uint32_t lba, uint8_t *buffer, ftl_req_cb_t cb, void *arg);
+ftl_req_t *ftl_submit_write(uint32_t lba, const uint8_t *buffer, ftl_req_cb_t cb, void *arg);
+
+int ftl_req_poll(const ftl_req_t *req);     // 1 = 완료
+int ftl_req_wait(ftl_req_t *req);           // 완료까지 대기, status 반환 (0 = ok, -1 = LBA 범위 밖 / write 실패)
+void ftl_req_release(ftl_req_t *req);
+
+#endif
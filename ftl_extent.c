@@ -0,0 +1,185 @@
+#include <stdlib.h>
+#include <string.h>
+#include "ftl_extent.h"
+
+int extent_map_init(extent_map_t *m, uint32_t nlbas) {
+    m->nlbas = nlbas;
+    m->nsegs = (nlbas + EXTENT_SEG_PAGES - 1) >> EXTENT_SEG_SHIFT;
+    m->seg = (extent_seg_t *)calloc(m->nsegs, sizeof(extent_seg_t));
+    if (!m->seg) return -1;
+    m->bytes = sizeof(extent_seg_t) * (uint64_t)m->nsegs;
+    return 0;
+}
+
+void extent_map_free(extent_map_t *m) {
+    for (uint32_t i = 0; m->seg && i < m->nsegs; i++) {
+        free(m->seg[i].ext);
+        free(m->seg[i].pages);
+    }
+    free(m->seg);
+    m->seg = NULL;
+    m->nsegs = 0;
+    m->bytes = 0;
+}
+
+// off를 포함할 수 있는 extent: off <= o 인 마지막 것 (-1 = 없음)
+static int ext_find(const extent_seg_t *s, uint32_t o) {
+    int lo = 0, hi = s->count - 1, found = -1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (s->ext[mid].off <= o) {
+            found = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return found;
+}
+
+// page leaf에서 i가 연속 구간의 시작인지
+static int run_start(const uint32_t *p, uint32_t i) {
+    if (i >= EXTENT_SEG_PAGES || p[i] == 0xFFFFFFFF) return 0;
+    return i == 0 || p[i - 1] == 0xFFFFFFFF || p[i] != p[i - 1] + 1;
+}
+
+static int ext_reserve(extent_map_t *m, extent_seg_t *s, int need) {
+    if (need <= s->cap) return 0;
+    int cap = s->cap ? s->cap * 2 : 4;
+    while (cap < need) cap *= 2;
+    extent_t *ext = (extent_t *)realloc(s->ext, sizeof(extent_t) * cap);
+    if (!ext) return -1;
+    m->bytes += sizeof(extent_t) * (uint64_t)(cap - s->cap);
+    s->ext = ext;
+    s->cap = (uint16_t)cap;
+    return 0;
+}
+
+static int ext_insert(extent_map_t *m, extent_seg_t *s, int at, extent_t e) {
+    if (ext_reserve(m, s, s->count + 1) != 0) return -1;
+    memmove(&s->ext[at + 1], &s->ext[at], sizeof(extent_t) * (s->count - at));
+    s->ext[at] = e;
+    s->count++;
+    return 0;
+}
+
+static void ext_remove(extent_seg_t *s, int at) {
+    memmove(&s->ext[at], &s->ext[at + 1], sizeof(extent_t) * (s->count - at - 1));
+    s->count--;
+}
+
+// extent leaf -> page leaf
+static int seg_to_pages(extent_map_t *m, extent_seg_t *s) {
+    uint32_t *p = (uint32_t *)malloc(sizeof(uint32_t) * EXTENT_SEG_PAGES);
+    int runs = 0;
+    if (!p) return -1;
+    memset(p, 0xFF, sizeof(uint32_t) * EXTENT_SEG_PAGES);
+    for (int i = 0; i < s->count; i++) {
+        for (int k = 0; k < s->ext[i].len; k++) p[s->ext[i].off + k] = s->ext[i].ppa + k;
+    }
+    for (uint32_t i = 0; i < EXTENT_SEG_PAGES; i++) runs += run_start(p, i);
+
+    m->bytes += sizeof(uint32_t) * EXTENT_SEG_PAGES - sizeof(extent_t) * (uint64_t)s->cap;
+    free(s->ext);
+    s->ext = NULL;
+    s->cap = 0;
+    s->pages = p;
+    s->count = (uint16_t)runs;
+    return 0;
+}
+
+// page leaf -> extent leaf (연속 구간이 count 개)
+static int seg_to_extents(extent_map_t *m, extent_seg_t *s) {
+    extent_seg_t e = { 0 };
+    extent_map_t tmp = { 0 };
+    if (s->count && ext_reserve(&tmp, &e, s->count) != 0) return -1;
+
+    for (uint32_t i = 0; i < EXTENT_SEG_PAGES; i++) {
+        if (!run_start(s->pages, i)) continue;
+        uint32_t len = 1;
+        while (i + len < EXTENT_SEG_PAGES && s->pages[i + len] == s->pages[i] + len) len++;
+        e.ext[e.count++] = (extent_t){ .off = (uint16_t)i, .len = (uint16_t)len, .ppa = s->pages[i] };
+    }
+    m->bytes += tmp.bytes - sizeof(uint32_t) * EXTENT_SEG_PAGES;
+    free(s->pages);
+    *s = e;
+    return 0;
+}
+
+uint32_t extent_map_get(const extent_map_t *m, uint32_t lba) {
+    if (lba >= m->nlbas) return 0xFFFFFFFF;
+    const extent_seg_t *s = &m->seg[lba >> EXTENT_SEG_SHIFT];
+    uint32_t o = lba & (EXTENT_SEG_PAGES - 1);
+
+    if (s->pages) return s->pages[o];
+    int i = ext_find(s, o);
+    if (i < 0 || o >= (uint32_t)s->ext[i].off + s->ext[i].len) return 0xFFFFFFFF;
+    return s->ext[i].ppa + (o - s->ext[i].off);
+}
+
+// page leaf: 바뀌는 자리와 그 다음 자리의 구간 시작 여부만 다시 셈
+static int pages_set(extent_map_t *m, extent_seg_t *s, uint32_t o, uint32_t ppa) {
+    int runs = s->count - run_start(s->pages, o) - run_start(s->pages, o + 1);
+    s->pages[o] = ppa;
+    runs += run_start(s->pages, o) + run_start(s->pages, o + 1);
+    s->count = (uint16_t)runs;
+    if (runs <= EXTENT_MERGE) seg_to_extents(m, s);     // 실패하면 page leaf 유지
+    return 0;
+}
+
+int extent_map_set(extent_map_t *m, uint32_t lba, uint32_t ppa) {
+    if (lba >= m->nlbas) return -1;
+    extent_seg_t *s = &m->seg[lba >> EXTENT_SEG_SHIFT];
+    uint32_t o = lba & (EXTENT_SEG_PAGES - 1);
+
+    if (s->pages) return pages_set(m, s, o, ppa);
+
+    // 1. o를 포함한 extent를 잘라 o를 비움 (가운데면 둘로 나뉨)
+    int i = ext_find(s, o);
+    if (i >= 0 && o < (uint32_t)s->ext[i].off + s->ext[i].len) {
+        extent_t e = s->ext[i];
+        uint32_t left = o - e.off, right = e.off + e.len - o - 1;
+        if (left && right) {
+            // 나눌 자리가 없으면 page leaf로
+            if (s->count >= EXTENT_MAX) {
+                if (seg_to_pages(m, s) != 0) return -1;
+                return pages_set(m, s, o, ppa);
+            }
+            extent_t r = { .off = (uint16_t)(o + 1), .len = (uint16_t)right, .ppa = e.ppa + left + 1 };
+            if (ext_insert(m, s, i + 1, r) != 0) return -1;
+            s->ext[i].len = (uint16_t)left;
+        } else if (left) {
+            s->ext[i].len = (uint16_t)left;
+        } else if (right) {
+            s->ext[i].off++;
+            s->ext[i].ppa++;
+            s->ext[i].len--;
+            i--;
+        } else {
+            ext_remove(s, i);
+            i--;
+        }
+    }
+    if (ppa == 0xFFFFFFFF) return 0;
+
+    // 2. 앞 / 뒤 extent에 이어지면 합치고, 아니면 새 extent
+    int j = i + 1;
+    int merge_l = i >= 0 && s->ext[i].off + s->ext[i].len == o && s->ext[i].ppa + s->ext[i].len == ppa;
+    int merge_r = j < s->count && s->ext[j].off == o + 1 && s->ext[j].ppa == ppa + 1;
+    if (merge_l && merge_r) {
+        s->ext[i].len += 1 + s->ext[j].len;
+        ext_remove(s, j);
+    } else if (merge_l) {
+        s->ext[i].len++;
+    } else if (merge_r) {
+        s->ext[j].off--;
+        s->ext[j].ppa--;
+        s->ext[j].len++;
+    } else if (s->count >= EXTENT_MAX) {
+        if (seg_to_pages(m, s) != 0) return -1;
+        return pages_set(m, s, o, ppa);
+    } else {
+        return ext_insert(m, s, j, (extent_t){ .off = (uint16_t)o, .len = 1, .ppa = ppa });
+    }
+    return 0;
+}
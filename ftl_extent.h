@@ -0,0 +1,42 @@
+// ftl_extent.h
+#ifndef FTL_EXTENT_H
+#define FTL_EXTENT_H
+
+#include <stdint.h>
+
+// extent 기반 L2P
+// LBA 공간을 EXTENT_SEG_PAGES 크기 segment로 나누고 segment 마다
+//  - extent leaf: (off, len, ppa) 정렬 배열, 연속 LBA -> 연속 PPA 구간을 entry 하나로
+//  - page leaf  : extent가 EXTENT_MAX 개를 넘으면 (fragmentation) page 별 entry로 전환
+// page leaf에서 연속 구간이 EXTENT_MERGE 개 이하로 줄면 다시 extent leaf로 돌아감
+#define EXTENT_SEG_SHIFT    10
+#define EXTENT_SEG_PAGES    (1 << EXTENT_SEG_SHIFT)
+#define EXTENT_MAX          256     // extent leaf 크기 상한 (8B x 256 = page leaf의 절반)
+#define EXTENT_MERGE        64
+
+typedef struct {
+    uint16_t off;       // segment 안 시작 위치
+    uint16_t len;
+    uint32_t ppa;
+} extent_t;
+
+typedef struct {
+    extent_t *ext;      // off 순 정렬, page leaf이면 NULL
+    uint32_t *pages;    // page leaf (0xFFFFFFFF = unmapped), extent leaf이면 NULL
+    uint16_t count;     // extent 수 / page leaf에서는 연속 구간 수
+    uint16_t cap;
+} extent_seg_t;
+
+typedef struct {
+    extent_seg_t *seg;
+    uint32_t nsegs;
+    uint32_t nlbas;
+    uint64_t bytes;     // 할당한 메모리 (segment table + leaf)
+} extent_map_t;
+
+int extent_map_init(extent_map_t *m, uint32_t nlbas);  // 전부 unmapped
+void extent_map_free(extent_map_t *m);
+uint32_t extent_map_get(const extent_map_t *m, uint32_t lba);  // 0xFFFFFFFF = unmapped
+int extent_map_set(extent_map_t *m, uint32_t lba, uint32_t ppa);  // ppa 0xFFFFFFFF = unmap, -1 = 메모리 부족
+
+#endif
@@ -0,0 +1,148 @@
+#include <stdlib.h>
+#include "ftl_victim.h"
+
+// 내부 list는 slot 번호로 연결, API는 block 번호 (block = first + slot * stride)
+static int block_slot(const victim_index_t *vi, int block) {
+    int off = block - vi->first;
+    if (off < 0 || off % vi->stride) return -1;
+    off /= vi->stride;
+    return off < vi->nblocks ? off : -1;
+}
+
+static int slot_block(const victim_index_t *vi, int slot) {
+    return slot < 0 ? -1 : vi->first + slot * vi->stride;
+}
+
+int victim_index_init(victim_index_t *vi, int nblocks, int max_count, int first, int stride) {
+    vi->nblocks = nblocks;
+    vi->first = first;
+    vi->stride = stride > 0 ? stride : 1;
+    vi->max_count = max_count;
+    vi->top = -1;
+    vi->size = 0;
+    vi->head = (int *)malloc(sizeof(int) * (max_count + 1));
+    vi->next = (int *)malloc(sizeof(int) * nblocks);
+    vi->prev = (int *)malloc(sizeof(int) * nblocks);
+    vi->bucket = (int *)malloc(sizeof(int) * nblocks);
+    vi->newer = (int *)malloc(sizeof(int) * nblocks);
+    vi->older = (int *)malloc(sizeof(int) * nblocks);
+    vi->oldest = vi->newest = -1;
+    if (!vi->head || !vi->next || !vi->prev || !vi->bucket || !vi->newer || !vi->older) {
+        victim_index_free(vi);
+        return -1;
+    }
+
+    for (int c = 0; c <= max_count; c++) vi->head[c] = -1;
+    for (int i = 0; i < nblocks; i++) {
+        vi->next[i] = vi->prev[i] = -1;
+        vi->newer[i] = vi->older[i] = -1;
+        vi->bucket[i] = -1;
+    }
+    return 0;
+}
+
+void victim_index_free(victim_index_t *vi) {
+    free(vi->head);
+    free(vi->next);
+    free(vi->prev);
+    free(vi->bucket);
+    free(vi->newer);
+    free(vi->older);
+    vi->head = vi->next = vi->prev = vi->bucket = NULL;
+    vi->newer = vi->older = NULL;
+    vi->oldest = vi->newest = -1;
+    vi->size = 0;
+    vi->top = -1;
+}
+
+// bucket list만 다시 연결 (FIFO 위치는 그대로)
+static void bucket_link(victim_index_t *vi, int slot, int invalid_count) {
+    if (invalid_count > vi->max_count) invalid_count = vi->max_count;
+    if (invalid_count < 0) invalid_count = 0;
+
+    // bucket 앞에 연결
+    vi->prev[slot] = -1;
+    vi->next[slot] = vi->head[invalid_count];
+    if (vi->head[invalid_count] != -1) vi->prev[vi->head[invalid_count]] = slot;
+    vi->head[invalid_count] = slot;
+    vi->bucket[slot] = invalid_count;
+
+    if (invalid_count > vi->top) vi->top = invalid_count;
+}
+
+static void bucket_unlink(victim_index_t *vi, int slot) {
+    int c = vi->bucket[slot];
+    if (vi->prev[slot] != -1) vi->next[vi->prev[slot]] = vi->next[slot];
+    else vi->head[c] = vi->next[slot];
+    if (vi->next[slot] != -1) vi->prev[vi->next[slot]] = vi->prev[slot];
+
+    vi->next[slot] = vi->prev[slot] = -1;
+    vi->bucket[slot] = -1;
+}
+
+void victim_index_insert(victim_index_t *vi, int block, int invalid_count) {
+    int slot = block_slot(vi, block);
+    if (slot < 0 || vi->bucket[slot] != -1) return;
+    bucket_link(vi, slot, invalid_count);
+
+    // FIFO 끝에 연결
+    vi->newer[slot] = -1;
+    vi->older[slot] = vi->newest;
+    if (vi->newest != -1) vi->newer[vi->newest] = slot;
+    else vi->oldest = slot;
+    vi->newest = slot;
+    vi->size++;
+}
+
+void victim_index_remove(victim_index_t *vi, int block) {
+    int slot = block_slot(vi, block);
+    if (slot < 0 || vi->bucket[slot] == -1) return;
+    bucket_unlink(vi, slot);
+
+    if (vi->older[slot] != -1) vi->newer[vi->older[slot]] = vi->newer[slot];
+    else vi->oldest = vi->newer[slot];
+    if (vi->newer[slot] != -1) vi->older[vi->newer[slot]] = vi->older[slot];
+    else vi->newest = vi->older[slot];
+    vi->newer[slot] = vi->older[slot] = -1;
+    vi->size--;
+}
+
+void victim_index_inc(victim_index_t *vi, int block) {
+    int slot = block_slot(vi, block);
+    if (slot < 0) return;
+    int c = vi->bucket[slot];
+    if (c == -1) return;
+
+    bucket_unlink(vi, slot);
+    bucket_link(vi, slot, c + 1);
+}
+
+int victim_index_contains(const victim_index_t *vi, int block) {
+    int slot = block_slot(vi, block);
+    return slot >= 0 && vi->bucket[slot] != -1;
+}
+
+int victim_index_pick(victim_index_t *vi) {
+    // top은 insert 때만 올라가고 여기서만 내려감 -> 최대 max_count 만큼만 스캔
+    while (vi->top >= 0 && vi->head[vi->top] == -1) vi->top--;
+    return (vi->top < 0) ? -1 : slot_block(vi, vi->head[vi->top]);
+}
+
+int victim_index_next(const victim_index_t *vi, int block) {
+    int slot = block_slot(vi, block);
+    if (slot < 0 || vi->bucket[slot] == -1) return -1;
+    if (vi->next[slot] != -1) return slot_block(vi, vi->next[slot]);
+    for (int c = vi->bucket[slot] - 1; c >= 0; c--) {
+        if (vi->head[c] != -1) return slot_block(vi, vi->head[c]);
+    }
+    return -1;
+}
+
+int victim_index_oldest(const victim_index_t *vi) {
+    return slot_block(vi, vi->oldest);
+}
+
+int victim_index_newer(const victim_index_t *vi, int block) {
+    int slot = block_slot(vi, block);
+    return slot < 0 ? -1 : slot_block(vi, vi->newer[slot]);
+}
@@ -0,0 +1,38 @@
+// ftl_victim.h
+#ifndef FTL_VICTIM_H
+#define FTL_VICTIM_H
+
+// GC victim index
+// closed block들을 invalid page 수 별 bucket list로 관리 -> O(1) victim 선택
+// 같은 block들을 insert 순서 (= close 순서) FIFO list로도 연결 -> 오래된 block부터 O(1)씩 훑음
+typedef struct {
+    int nblocks;        // indexed blocks: first, first + stride, ... (nblocks 개)
+    int first;
+    int stride;
+    int max_count;      // bucket range: 0 ~ max_count
+    int top;            // highest bucket that may be non-empty
+    int size;           // number of indexed blocks
+    // 아래 list는 block 번호가 아니라 slot (block - first) / stride 로 연결
+    int *head;          // bucket head slot, -1 = empty
+    int *next;          // per-slot list links
+    int *prev;
+    int *bucket;        // bucket of each slot, -1 = not indexed
+    int oldest;         // FIFO head (first inserted), -1 = empty
+    int newest;         // FIFO tail
+    int *newer;         // per-slot FIFO links
+    int *older;
+} victim_index_t;
+
+// die 별 index: first = die, stride = NAND_DIES -> die의 block 수만큼만 할당
+int victim_index_init(victim_index_t *vi, int nblocks, int max_count, int first, int stride);
+void victim_index_free(victim_index_t *vi);
+void victim_index_insert(victim_index_t *vi, int block, int invalid_count);
+void victim_index_remove(victim_index_t *vi, int block);
+void victim_index_inc(victim_index_t *vi, int block);    // invalid_count + 1 (no-op if not indexed)
+int victim_index_pick(victim_index_t *vi);    // block with most invalid pages, -1 if empty
+int victim_index_next(const victim_index_t *vi, int block);     // next block in pick order (same or fewer invalid), -1 = end
+int victim_index_oldest(const victim_index_t *vi);              // first inserted block, -1 if empty
+int victim_index_newer(const victim_index_t *vi, int block);    // next block in insert order, -1 = end
+int victim_index_contains(const victim_index_t *vi, int block);
+
+#endif
@@ -1,37 +1,194 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include "ftl.h"
 #include "nand_hal.h"
 
-int main() {
-    printf("=== FTL Simulation Start (User Space) ===\n");
-    if (ftl_init() != 0) {
+#define STRESS_PAGES    80000
+#define HOT_LBAS        200
+
+// idle 구간: IDLE_EVERY 번 write 마다 host가 IDLE_NS 동안 쉼
+#define IDLE_EVERY      64
+#define IDLE_NS         3000000ULL
+
+#define WB_PAGES        256     // hot LBA 전체가 들어가는 write buffer
+
+#define REOPEN_IMAGE    "ftl_reopen.img"
+#define REOPEN_LBAS     5000
+#define REOPEN_WRITES   40000   // GC가 돌 만큼 덮어씀
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// burst 1 = ftl_write, burst > 1 = ftl_write_multi (연속 LBA burst)
+// idle: IDLE_EVERY 마다 ftl_idle() 호출, bg_gc: idle 구간에 background GC 허용
+// wb_pages: write buffer 크기 (0 = 없음)
+static int run_stress(int burst, int idle, int bg_gc, int wb_pages) {
+    // sparse backend: 실제로 쓴 page만 메모리 사용
+    nand_config_t nand_cfg = { .backend = NAND_BACKEND_SPARSE };
+    if (ftl_init(&nand_cfg) != 0) {
         printf("Init Failed\n");
         return -1;
     }
+    // burst 최대 한 block 분량 (page 크기는 init 후에 정해짐)
+    size_t buf_size = (size_t)PAGES_PER_BLOCK * NAND_PAGE_SIZE;
+    uint8_t *buf = (uint8_t *)malloc(buf_size);
+    if (!buf) {
+        ftl_exit();
+        return -1;
+    }
+    memset(buf, 0xAB, buf_size);
+    if (!bg_gc) ftl_set_gc_watermarks(0, 0);
+    if (wb_pages) ftl_set_write_buffer(wb_pages);
 
-    uint8_t buf[NAND_PAGE_SIZE];
-    memset(buf, 0xAB, NAND_PAGE_SIZE);
-
-    printf("Starting Stress Test (Writing 80,000 pages)...\n");
+    printf("Starting Stress Test (Writing 80,000 pages, burst %d%s%s", burst,
+           idle ? ", idle gaps" : "", bg_gc ? ", background GC" : "");
+    if (wb_pages) printf(", %d-page write buffer", wb_pages);
+    printf(")...\n");
+    double t0 = now_sec();
     // 총 용량(약 65,000 페이지)보다 많이 써서 GC를 유발함
-    for (int i = 0; i < 80000; i++) {
-        uint32_t lba = i % 200; // 0~199번 LBA만 계속 덮어쓰기 (Hot Data)
-        ftl_write(lba, buf);
+    for (int i = 0; i < STRESS_PAGES; i += burst) {
+        uint32_t lba = i % HOT_LBAS; // 0~199번 LBA만 계속 덮어쓰기 (Hot Data)
+        if (burst == 1) ftl_write(lba, buf);
+        else ftl_write_multi(lba, burst, buf);
+        if (idle && (i + burst) % IDLE_EVERY == 0) ftl_idle(IDLE_NS);
         
-        if (i % 5000 == 0) printf(" - Written %d pages (GC Running...)\n", i);
+        if (i % 5000 == 0) {
+            ftl_stats_t st;
+            ftl_get_stats(&st);
+            printf(" - Written %d pages (GC Running...) free blocks: %u\n", i, st.free_blocks);
+        }
     }
+    ftl_flush();    // durability point: buffer에 남은 page까지 NAND로
+    double elapsed = now_sec() - t0;
 
     // 검증
     uint8_t r_buf[NAND_PAGE_SIZE];
-    ftl_read(199, r_buf); // 마지막 루프의 199번 데이터 확인
+    ftl_read(HOT_LBAS - 1, r_buf); // 마지막 루프의 199번 데이터 확인
     
-    if (r_buf[0] == 0xAB) {
+    int ok = (r_buf[0] == 0xAB);
+    if (ok) {
         printf("[Success] Test Completed. Data Integrity Verified.\n");
     } else {
         printf("[Fail] Data Mismatch!\n");
     }
 
+    ftl_stats_t st;
+    ftl_get_stats(&st);
+    printf("Throughput: %.0f pages/sec (%.3f s)\n", STRESS_PAGES / elapsed, elapsed);
+
+    // virtual NAND time: die들이 겹쳐서 동작한 결과
+    uint64_t finish = nand_get_finish_time();
+    uint64_t busy = 0;
+    for (int d = 0; d < NAND_DIES; d++) busy += nand_get_die_busy(d);
+    printf("Virtual Time: %.1f ms, %.0f pages/sec, die utilization %.1f%% (%d dies)\n",
+           finish / 1e6, STRESS_PAGES / (finish / 1e9),
+           100.0 * busy / ((double)finish * NAND_DIES), NAND_DIES);
+    printf("GC Count: %llu (background %llu), Free Blocks: %u (min %u)\n",
+           (unsigned long long)st.gc_count, (unsigned long long)st.bg_gc_count,
+           st.free_blocks, st.min_free_blocks);
+    printf("NAND Programs: host %llu + GC %llu for %llu written pages (WAF %.2f), absorbed by write buffer %llu\n",
+           (unsigned long long)st.nand_pages, (unsigned long long)st.gc_pages,
+           (unsigned long long)st.host_pages,
+           st.host_pages ? (double)(st.nand_pages + st.gc_pages) / st.host_pages : 0.0,
+           (unsigned long long)st.wb_hits);
+    printf("Write Latency: p99 %.1f us, p99.9 %.1f us, max %.1f us\n",
+           ftl_get_latency(FTL_OP_WRITE, 99) / 1e3, ftl_get_latency(FTL_OP_WRITE, 99.9) / 1e3,
+           ftl_get_latency(FTL_OP_WRITE, 100) / 1e3);
+    printf("Resident NAND Pages: %u / %d\n", nand_get_resident_pages(), BLOCKS_PER_CHIP * PAGES_PER_BLOCK);
+
     ftl_exit();
+    free(buf);
+    return ok ? 0 : -1;
+}
+
+// LBA마다 (lba, version)으로 page를 채움
+static void fill_page(uint8_t *buf, uint32_t lba, uint32_t version) {
+    for (int i = 0; i + 8 <= NAND_PAGE_SIZE; i += 8) {
+        memcpy(buf + i, &lba, 4);
+        memcpy(buf + i + 4, &version, 4);
+    }
+}
+
+// 0 = 전부 일치
+static int verify_pages(const uint32_t *version, uint8_t *buf, uint8_t *expect) {
+    int bad = 0;
+    for (uint32_t lba = 0; lba < REOPEN_LBAS; lba++) {
+        ftl_read(lba, buf);
+        if (version[lba]) fill_page(expect, lba, version[lba]);
+        else memset(expect, 0xFF, NAND_PAGE_SIZE);
+        if (memcmp(buf, expect, NAND_PAGE_SIZE) != 0) bad++;
+    }
+    return bad;
+}
+
+// FILE backend image를 닫았다가 format 없이 다시 열어도 data가 그대로이고 이어서 쓸 수 있는지
+static int run_reopen(void) {
+    nand_config_t nand_cfg = { .backend = NAND_BACKEND_FILE, .image_path = REOPEN_IMAGE, .format = 1, .no_timing = 1 };
+    uint32_t *version = (uint32_t *)calloc(REOPEN_LBAS, sizeof(uint32_t));
+    uint8_t *buf = (uint8_t *)malloc(NAND_MAX_PAGE_SIZE);
+    uint8_t *expect = (uint8_t *)malloc(NAND_MAX_PAGE_SIZE);
+    uint32_t gen = 0;
+    unsigned seed = 1;
+    int bad = 0;
+
+    printf("Starting Reopen Test (%d LBAs, image %s)...\n", REOPEN_LBAS, REOPEN_IMAGE);
+    if (!version || !buf || !expect) bad = -1;
+    for (int round = 0; round < 3 && bad == 0; round++) {
+        if (ftl_init(&nand_cfg) != 0) {
+            bad = -1;
+            break;
+        }
+        if (round > 0) bad += verify_pages(version, buf, expect);
+        // round 0은 전체를 한 번 쓰고, 이후는 앞쪽 LBA 위주로 덮어쓰기
+        for (int i = 0; i < REOPEN_WRITES; i++) {
+            uint32_t lba = round == 0 && i < REOPEN_LBAS ? (uint32_t)i
+                         : (uint32_t)rand_r(&seed) % (rand_r(&seed) % 4 ? REOPEN_LBAS / 10 : REOPEN_LBAS);
+            fill_page(buf, lba, version[lba] = ++gen);
+            ftl_write(lba, buf);
+        }
+        bad += verify_pages(version, buf, expect);
+        ftl_exit();
+        nand_cfg.format = 0;
+    }
+
+#ifndef NAND_FIXED_GEOMETRY
+    // 다른 geometry로 열면 image를 쓰지 않고 새로 format (고정 geometry build는 다른 geometry를 거부)
+    if (bad == 0) {
+        nand_cfg.geometry.pages_per_block = NAND_DEFAULT_PAGES_PER_BLOCK * 2;
+        memset(version, 0, REOPEN_LBAS * sizeof(uint32_t));
+        if (ftl_init(&nand_cfg) != 0) bad = -1;
+        else {
+            bad += verify_pages(version, buf, expect);
+            ftl_exit();
+        }
+    }
+#endif
+    unlink(REOPEN_IMAGE);
+    free(version);
+    free(buf);
+    free(expect);
+
+    if (bad == 0) printf("[Success] Reopen Test Completed. Data Integrity Verified.\n");
+    else printf("[Fail] Reopen Test: %d mismatched pages\n", bad);
+    return bad == 0 ? 0 : -1;
+}
+
+int main() {
+    printf("=== FTL Simulation Start (User Space) ===\n");
+    if (run_stress(1, 0, 0, 0) != 0) return -1;
+    if (run_stress(8, 0, 0, 0) != 0) return -1;
+    // 같은 idle 구간에서 background GC 유무에 따른 write tail latency 비교
+    if (run_stress(1, 1, 0, 0) != 0) return -1;
+    if (run_stress(1, 1, 1, 0) != 0) return -1;
+    // write buffer가 hot LBA 덮어쓰기를 흡수할 때 NAND program / GC 감소
+    if (run_stress(1, 0, 0, WB_PAGES) != 0) return -1;
+    // image 재사용: OOB에서 mapping 복원
+    if (run_reopen() != 0) return -1;
     return 0;
 }
@@ -12,7 +12,7 @@ MODULE_DESCRIPTION("NAND FTL Simulator");
 static int __init nand_ftl_init_module(void) {
     printk(KERN_INFO "[FTL-MOD] Loading Module...\n");
 
-    if (ftl_init() < 0) return -ENOMEM;
+    if (ftl_init(NULL) < 0) return -ENOMEM;
 
     // === STRESS TEST START ===
     // 커널이 멈추지 않도록 적절한 양만 테스트 (약 2000 페이지 쓰기)
@@ -1,88 +1,618 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "nand_hal.h"
 
-typedef struct {
-    uint8_t data[NAND_PAGE_SIZE];
-    uint8_t oob[NAND_OOB_SIZE];
-    uint8_t is_written; // 덮어쓰기 방지 플래그
-} nand_page_t;
+// Structure-of-arrays 저장 구조
+//  - data : page data (NAND_PAGE_SIZE per page)
+//  - oob  : spare area (NAND_OOB_SIZE per page), data와 분리되어 OOB scan이 연속 접근
+//  - state: block 당 written bitmap (덮어쓰기 방지 플래그)
+// bit가 0인 page는 backend와 무관하게 erased(0xFF)로 읽힘
+//
+// 동시 호출: 서로 다른 page의 program / read는 lock 없이 병렬 진행
+//  - written bit는 atomic OR (data memcpy 후 release), read는 acquire로 확인
+//  - 같은 block의 erase와 read/program이 겹치지 않게 하는 것은 FTL 책임
+//  - timing model(공유 timeline)만 time_lock으로 직렬화
+
+#define NAND_TOTAL_PAGES    ((uint32_t)BLOCKS_PER_CHIP * PAGES_PER_BLOCK)
+#define STATE_WORDS         ((PAGES_PER_BLOCK + 63) / 64)   // bitmap words per block
+
+// FILE backend image layout: [data][oob][state bitmap][erase count][bad block table][header]
+#define IMG_DATA_SIZE       ((size_t)NAND_TOTAL_PAGES * NAND_PAGE_SIZE)
+#define IMG_OOB_SIZE        ((size_t)NAND_TOTAL_PAGES * NAND_OOB_SIZE)
+#define IMG_STATE_SIZE      ((size_t)BLOCKS_PER_CHIP * STATE_WORDS * sizeof(uint64_t))
+#define IMG_ERASE_SIZE      ((size_t)BLOCKS_PER_CHIP * sizeof(uint32_t))
+#define IMG_HDR_OFF         (IMG_DATA_SIZE + IMG_OOB_SIZE + IMG_STATE_SIZE + IMG_ERASE_SIZE + BLOCKS_PER_CHIP)
+#define IMG_SIZE            (IMG_HDR_OFF + sizeof(img_header_t))
+#define IMG_MAGIC           0x31474D49444E414EULL     // "NANDIMG1"
 
+// image가 이 geometry로 만든 것인지 (크기만으로는 geometry가 달라도 같을 수 있음)
 typedef struct {
-    nand_page_t pages[PAGES_PER_BLOCK];
-    int is_bad;
-} nand_block_t;
+    uint64_t magic;
+    uint32_t page_size;
+    uint32_t oob_size;
+    uint32_t pages_per_block;
+    uint32_t blocks;
+} img_header_t;
 
-static nand_block_t *nand_device = NULL;
+nand_geo_t nand_geo = {
+    .page_size = NAND_DEFAULT_PAGE_SIZE,
+    .oob_size = NAND_DEFAULT_OOB_SIZE,
+    .pages_per_block = NAND_DEFAULT_PAGES_PER_BLOCK,
+    .blocks = NAND_DEFAULT_BLOCKS,
+    .block_shift = __builtin_ctz(NAND_DEFAULT_PAGES_PER_BLOCK),
+};
 
-int nand_init(void) {
-    // 256MB 메모리 할당
-    nand_device = (nand_block_t *)malloc(sizeof(nand_block_t) * BLOCKS_PER_CHIP);
-    if (!nand_device) return -1;
+static nand_backend_t backend = NAND_BACKEND_RAM;
+static uint8_t *page_data = NULL;       // RAM / FILE
+static uint8_t *page_oob = NULL;        // RAM / FILE
+static uint8_t **sparse_data = NULL;    // SPARSE: per page, NULL = no backing
+static uint8_t **sparse_oob = NULL;     // SPARSE: per block
+static uint64_t *written_map = NULL;
+static uint32_t *erase_count = NULL;    // block 별 누적 erase 횟수 (atomic)
+static uint8_t *bad_table = NULL;       // NULL = not initialized
+static uint32_t resident_pages = 0;    // atomic
 
-    // 초기화 (ALL 0xFF)
-    for (int i = 0; i < BLOCKS_PER_CHIP; i++) {
-        nand_device[i].is_bad = 0;
-        for (int j = 0; j < PAGES_PER_BLOCK; j++) {
-            memset(nand_device[i].pages[j].data, 0xFF, NAND_PAGE_SIZE);
-            memset(nand_device[i].pages[j].oob, 0xFF, NAND_OOB_SIZE);
-            nand_device[i].pages[j].is_written = 0;
-        }
+// FILE backend
+static int img_fd = -1;
+static uint8_t *img_map = NULL;
+static int img_reused = 0;              // 기존 image를 format 없이 열었음
+
+// 기본 동작 시간
+#define DEFAULT_T_READ_NS   50000       // tR
+#define DEFAULT_T_PROG_NS   600000      // tPROG
+#define DEFAULT_T_ERASE_NS  3000000     // tBERS
+#define DEFAULT_T_BYTE_PS   2500        // 400MB/s channel bus
+
+#define BLOCK_CHANNEL(block)    ((block) % NAND_CHANNELS)
+
+// timing model: die / channel 별 busy timeline (virtual ns)
+static nand_timing_t timing;
+static int timing_on = 1;
+static uint64_t host_clock = 0;
+static uint64_t die_busy_until[NAND_DIES];
+static uint64_t die_busy_total[NAND_DIES];
+static uint64_t ch_busy_until[NAND_CHANNELS];
+static uint64_t ch_busy_total[NAND_CHANNELS];
+static pthread_mutex_t time_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static inline void time_lock_acquire(void) {
+    if (timing_on) pthread_mutex_lock(&time_lock);
+}
+
+static inline void time_lock_release(void) {
+    if (timing_on) pthread_mutex_unlock(&time_lock);
+}
+
+static inline uint64_t max_u64(uint64_t a, uint64_t b) {
+    return a > b ? a : b;
+}
+
+static inline uint64_t xfer_ns(size_t bytes) {
+    return (uint64_t)bytes * timing.t_byte_ps / 1000;
+}
+
+static void nand_reset_timeline(void) {
+    host_clock = 0;
+    memset(die_busy_until, 0, sizeof(die_busy_until));
+    memset(die_busy_total, 0, sizeof(die_busy_total));
+    memset(ch_busy_until, 0, sizeof(ch_busy_until));
+    memset(ch_busy_total, 0, sizeof(ch_busy_total));
+}
+
+// read: tR 후 channel로 data out, 완료 시각 반환
+static uint64_t nand_time_read(int block, size_t bytes) {
+    if (!timing_on) return host_clock;
+    int die = NAND_BLOCK_DIE(block);
+    int ch = BLOCK_CHANNEL(block);
+
+    uint64_t start = max_u64(host_clock, die_busy_until[die]);
+    uint64_t xs = max_u64(start + timing.t_read_ns, ch_busy_until[ch]);
+    uint64_t xe = xs + xfer_ns(bytes);
+    ch_busy_until[ch] = xe;
+    ch_busy_total[ch] += xe - xs;
+    die_busy_until[die] = xe;   // transfer 끝날 때까지 page register 점유
+    die_busy_total[die] += xe - start;
+    return xe;
+}
+
+// program: channel로 data in 후 tPROG, host는 data in 까지만 대기
+static void nand_time_prog(int block, size_t bytes) {
+    if (!timing_on) return;
+    int die = NAND_BLOCK_DIE(block);
+    int ch = BLOCK_CHANNEL(block);
+
+    uint64_t xs = max_u64(max_u64(host_clock, ch_busy_until[ch]), die_busy_until[die]);
+    uint64_t xe = xs + xfer_ns(bytes);
+    ch_busy_until[ch] = xe;
+    ch_busy_total[ch] += xe - xs;
+    die_busy_until[die] = xe + timing.t_prog_ns;
+    die_busy_total[die] += xe - xs + timing.t_prog_ns;
+    host_clock = xe;
+}
+
+// copy-back: 같은 die면 tR + tPROG 동안 die만 점유 (bus transfer 없음)
+// 다른 die면 read out -> program in 으로 처리
+static void nand_time_copyback(int src_block, int dst_block) {
+    if (!timing_on) return;
+    int die = NAND_BLOCK_DIE(src_block);
+
+    if (die != NAND_BLOCK_DIE(dst_block)) {
+        host_clock = nand_time_read(src_block, NAND_PAGE_SIZE + NAND_OOB_SIZE);
+        nand_time_prog(dst_block, NAND_PAGE_SIZE + NAND_OOB_SIZE);
+        return;
     }
-    return NAND_SUCCESS;
+    uint64_t start = max_u64(host_clock, die_busy_until[die]);
+    die_busy_until[die] = start + timing.t_read_ns + timing.t_prog_ns;
+    die_busy_total[die] += timing.t_read_ns + timing.t_prog_ns;
+    host_clock = start;
 }
 
-int nand_write(ppa_t ppa, const uint8_t *data, const uint8_t *oob) {
-    int block = ppa / PAGES_PER_BLOCK;
-    int page = ppa % PAGES_PER_BLOCK;
+// erase: 명령만 보내고 완료는 기다리지 않음
+static void nand_time_erase(int block) {
+    if (!timing_on) return;
+    int die = NAND_BLOCK_DIE(block);
+
+    uint64_t start = max_u64(host_clock, die_busy_until[die]);
+    die_busy_until[die] = start + timing.t_erase_ns;
+    die_busy_total[die] += timing.t_erase_ns;
+    host_clock = start;
+}
+
+static inline uint64_t *state_word(int block, int page) {
+    return &written_map[(size_t)block * STATE_WORDS + page / 64];
+}
+
+static inline int page_is_written(int block, int page) {
+    return (__atomic_load_n(state_word(block, page), __ATOMIC_ACQUIRE) >> (page % 64)) & 1;
+}
 
-    if (block >= BLOCKS_PER_CHIP || !nand_device) return NAND_ERR_INVALID;
-    if (nand_device[block].is_bad) return NAND_ERR_BADBLOCK;
+// SPARSE backend는 첫 write 때 data / OOB 버퍼 할당
+static uint8_t *nand_data_ptr(int block, int page, int alloc) {
+    size_t idx = (size_t)block * PAGES_PER_BLOCK + page;
+    if (backend != NAND_BACKEND_SPARSE) return page_data + idx * NAND_PAGE_SIZE;
 
+    if (!sparse_data[idx] && alloc) {
+        sparse_data[idx] = (uint8_t *)malloc(NAND_PAGE_SIZE);
+        if (sparse_data[idx]) __atomic_fetch_add(&resident_pages, 1, __ATOMIC_RELAXED);
+    }
+    return sparse_data[idx];
+}
+
+static uint8_t *nand_oob_ptr(int block, int page, int alloc) {
+    if (backend != NAND_BACKEND_SPARSE) {
+        return page_oob + ((size_t)block * PAGES_PER_BLOCK + page) * NAND_OOB_SIZE;
+    }
+
+    // 같은 block의 다른 page를 쓰는 thread끼리 경쟁할 수 있으므로 CAS로 한 번만 설치
+    uint8_t *o = __atomic_load_n(&sparse_oob[block], __ATOMIC_ACQUIRE);
+    if (!o && alloc) {
+        uint8_t *mine = (uint8_t *)malloc((size_t)PAGES_PER_BLOCK * NAND_OOB_SIZE);
+        if (!mine) return NULL;
+        if (__atomic_compare_exchange_n(&sparse_oob[block], &o, mine, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) o = mine;
+        else free(mine);
+    }
+    return o ? o + (size_t)page * NAND_OOB_SIZE : NULL;
+}
+
+static int nand_open_image(const nand_config_t *cfg) {
+    if (!cfg->image_path) return -1;
+
+    img_fd = open(cfg->image_path, O_RDWR | O_CREAT, 0644);
+    if (img_fd < 0) return -1;
+
+    struct stat st;
+    img_header_t hdr = { 0 };
+    const img_header_t want = {
+        .magic = IMG_MAGIC, .page_size = (uint32_t)NAND_PAGE_SIZE, .oob_size = (uint32_t)NAND_OOB_SIZE,
+        .pages_per_block = (uint32_t)PAGES_PER_BLOCK, .blocks = (uint32_t)BLOCKS_PER_CHIP,
+    };
+    if (fstat(img_fd, &st) != 0) return -1;
+    // header가 없거나 다른 geometry로 만든 image면 새로 포맷
+    int fresh = st.st_size != (off_t)IMG_SIZE ||
+                pread(img_fd, &hdr, sizeof(hdr), (off_t)IMG_HDR_OFF) != (ssize_t)sizeof(hdr) ||
+                memcmp(&hdr, &want, sizeof(hdr)) != 0;
+    if (fresh && st.st_size > 0) printf("[HAL] %s is not an image of this geometry, formatting\n", cfg->image_path);
+    // sparse file: 실제 쓴 page만 디스크 블록 할당
+    if (fresh && ftruncate(img_fd, 0) != 0) return -1;
+    if (fresh && ftruncate(img_fd, IMG_SIZE) != 0) return -1;
+    if (fresh && pwrite(img_fd, &want, sizeof(want), (off_t)IMG_HDR_OFF) != (ssize_t)sizeof(want)) return -1;
+
+    img_map = (uint8_t *)mmap(NULL, IMG_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, img_fd, 0);
+    if (img_map == MAP_FAILED) { img_map = NULL; return -1; }
+
+    page_data = img_map;
+    page_oob = page_data + IMG_DATA_SIZE;
+    written_map = (uint64_t *)(page_oob + IMG_OOB_SIZE);
+    erase_count = (uint32_t *)((uint8_t *)written_map + IMG_STATE_SIZE);
+    bad_table = (uint8_t *)erase_count + IMG_ERASE_SIZE;
+
+    // format은 새 장치로 취급: erase 횟수도 0부터
+    if (!fresh && cfg->format) {
+        for (int i = 0; i < BLOCKS_PER_CHIP; i++) nand_erase(i);
+        memset(erase_count, 0, IMG_ERASE_SIZE);
+        nand_reset_timeline();
+    }
+    img_reused = !fresh && !cfg->format;
+    return 0;
+}
+
+// 0인 항목은 기본값, 범위를 벗어나면 -1
+static int nand_set_geometry(const nand_geometry_t *g) {
+    nand_geo_t geo = {
+        .page_size = g->page_size ? (int)g->page_size : NAND_DEFAULT_PAGE_SIZE,
+        .oob_size = g->oob_size ? (int)g->oob_size : NAND_DEFAULT_OOB_SIZE,
+        .pages_per_block = g->pages_per_block ? (int)g->pages_per_block : NAND_DEFAULT_PAGES_PER_BLOCK,
+        .blocks = g->blocks ? (int)g->blocks : NAND_DEFAULT_BLOCKS,
+    };
+    // page는 L2P entry(4B) 단위, OOB는 앞 4B에 LBA, PPA는 0xFFFFFFFF / 최상위 bit를 FTL이 씀
+    if (g->page_size > NAND_MAX_PAGE_SIZE || g->oob_size > NAND_MAX_OOB_SIZE ||
+        g->pages_per_block > NAND_MAX_PAGES_PER_BLOCK || g->blocks > 0x7FFFFFFF ||
+        geo.page_size < 512 || geo.page_size % 4 || geo.oob_size < 8 || geo.pages_per_block < 4 ||
+        geo.blocks % (NAND_DIES * PLANES_PER_DIE) ||
+        (uint64_t)geo.blocks * geo.pages_per_block > 0x7FFFFFFF) {
+        return -1;
+    }
+#ifdef NAND_FIXED_GEOMETRY
+    if (geo.page_size != NAND_DEFAULT_PAGE_SIZE || geo.oob_size != NAND_DEFAULT_OOB_SIZE ||
+        geo.pages_per_block != NAND_DEFAULT_PAGES_PER_BLOCK || geo.blocks != NAND_DEFAULT_BLOCKS) {
+        return -1;
+    }
+#endif
+    geo.block_shift = (geo.pages_per_block & (geo.pages_per_block - 1)) ? -1 : __builtin_ctz(geo.pages_per_block);
+    nand_geo = geo;
+    return 0;
+}
+
+int nand_init(const nand_config_t *cfg) {
+    nand_geometry_t geometry = cfg ? cfg->geometry : (nand_geometry_t){ 0 };
+    if (nand_set_geometry(&geometry) != 0) {
+        printf("[HAL Error] Unsupported geometry (page %u, oob %u, pages/block %u, blocks %u)\n",
+               geometry.page_size, geometry.oob_size, geometry.pages_per_block, geometry.blocks);
+        return -1;
+    }
+    backend = cfg ? cfg->backend : NAND_BACKEND_RAM;
+    resident_pages = 0;
+    img_reused = 0;
+    nand_reset_timeline();
+
+    // 0인 항목은 기본값
+    timing_on = !(cfg && cfg->no_timing);
+    timing = cfg ? cfg->timing : (nand_timing_t){ 0 };
+    if (!timing.t_read_ns)  timing.t_read_ns = DEFAULT_T_READ_NS;
+    if (!timing.t_prog_ns)  timing.t_prog_ns = DEFAULT_T_PROG_NS;
+    if (!timing.t_erase_ns) timing.t_erase_ns = DEFAULT_T_ERASE_NS;
+    if (!timing.t_byte_ps)  timing.t_byte_ps = DEFAULT_T_BYTE_PS;
+
+    if (backend == NAND_BACKEND_FILE) {
+        // state bitmap / erase count / bad block table도 image에 같이 저장
+        if (nand_open_image(cfg) != 0) {
+            printf("[HAL Error] Cannot map image %s\n", cfg->image_path ? cfg->image_path : "(null)");
+            nand_exit();
+            return -1;
+        }
+        return NAND_SUCCESS;
+    }
+
+    bad_table = (uint8_t *)calloc(BLOCKS_PER_CHIP, sizeof(uint8_t));
+    written_map = (uint64_t *)calloc((size_t)BLOCKS_PER_CHIP * STATE_WORDS, sizeof(uint64_t));
+    erase_count = (uint32_t *)calloc(BLOCKS_PER_CHIP, sizeof(uint32_t));
+    if (!bad_table || !written_map || !erase_count) { nand_exit(); return -1; }
+
+    if (backend == NAND_BACKEND_SPARSE) {
+        // 쓰지 않은 page는 메모리 없이 erased(0xFF) 상태로 취급
+        sparse_data = (uint8_t **)calloc(NAND_TOTAL_PAGES, sizeof(uint8_t *));
+        sparse_oob = (uint8_t **)calloc(BLOCKS_PER_CHIP, sizeof(uint8_t *));
+        if (!sparse_data || !sparse_oob) { nand_exit(); return -1; }
+        return NAND_SUCCESS;
+    }
+
+    // 기본 geometry면 256MB 메모리 할당 (erased 여부는 bitmap이 판단하므로 0xFF 채우기 불필요)
+    page_data = (uint8_t *)malloc(IMG_DATA_SIZE);
+    page_oob = (uint8_t *)malloc(IMG_OOB_SIZE);
+    if (!page_data || !page_oob) { nand_exit(); return -1; }
+    resident_pages = NAND_TOTAL_PAGES;
+    return NAND_SUCCESS;
+}
+
+// 범위 / bad block 체크가 끝난 page 단위 동작
+static int nand_program_page(int block, int page, const uint8_t *data, const uint8_t *oob) {
     // 덮어쓰기 체크
-    if (nand_device[block].pages[page].is_written) {
+    if (page_is_written(block, page)) {
         printf("[HAL Error] Overwrite detected at Block %d Page %d\n", block, page);
         return NAND_ERR_OVERWRITE;
     }
 
-    if (data) memcpy(nand_device[block].pages[page].data, data, NAND_PAGE_SIZE);
-    if (oob)  memcpy(nand_device[block].pages[page].oob, oob, NAND_OOB_SIZE);
-    
-    nand_device[block].pages[page].is_written = 1;
+    uint8_t *d = nand_data_ptr(block, page, 1);
+    uint8_t *o = nand_oob_ptr(block, page, 1);
+    if (!d || !o) return NAND_ERR_INVALID;
+
+    // 빠진 부분은 erased 값(0xFF)으로 program
+    if (data) memcpy(d, data, NAND_PAGE_SIZE);
+    else memset(d, 0xFF, NAND_PAGE_SIZE);
+    if (oob)  memcpy(o, oob, NAND_OOB_SIZE);
+    else memset(o, 0xFF, NAND_OOB_SIZE);
+
+    __atomic_fetch_or(state_word(block, page), 1ULL << (page % 64), __ATOMIC_RELEASE);
     return NAND_SUCCESS;
 }
 
+static void nand_read_page(int block, int page, uint8_t *data, uint8_t *oob) {
+    if (!page_is_written(block, page)) {
+        if (data) memset(data, 0xFF, NAND_PAGE_SIZE);
+        if (oob)  memset(oob, 0xFF, NAND_OOB_SIZE);
+        return;
+    }
+
+    if (data) memcpy(data, nand_data_ptr(block, page, 0), NAND_PAGE_SIZE);
+    if (oob)  memcpy(oob, nand_oob_ptr(block, page, 0), NAND_OOB_SIZE);
+}
+
+int nand_write(ppa_t ppa, const uint8_t *data, const uint8_t *oob) {
+    int block = PPA_BLOCK(ppa);
+    int page = PPA_PAGE(ppa);
+
+    if (block >= BLOCKS_PER_CHIP || !bad_table) return NAND_ERR_INVALID;
+    if (bad_table[block]) return NAND_ERR_BADBLOCK;
+    time_lock_acquire();
+    nand_time_prog(block, NAND_PAGE_SIZE + NAND_OOB_SIZE);
+    time_lock_release();
+    return nand_program_page(block, page, data, oob);
+}
+
 int nand_read(ppa_t ppa, uint8_t *data, uint8_t *oob) {
-    int block = ppa / PAGES_PER_BLOCK;
-    int page = ppa % PAGES_PER_BLOCK;
+    int block = PPA_BLOCK(ppa);
+    int page = PPA_PAGE(ppa);
+
+    if (block >= BLOCKS_PER_CHIP || !bad_table) return NAND_ERR_INVALID;
+    if (timing_on) {
+        time_lock_acquire();
+        host_clock = nand_time_read(block, (data ? NAND_PAGE_SIZE : 0) + (oob ? NAND_OOB_SIZE : 0));
+        time_lock_release();
+    }
+    nand_read_page(block, page, data, oob);
+    return NAND_SUCCESS;
+}
+
+int nand_copyback(ppa_t src_ppa, ppa_t dst_ppa, const uint8_t *new_oob) {
+    int sb = PPA_BLOCK(src_ppa), sp = PPA_PAGE(src_ppa);
+    int db = PPA_BLOCK(dst_ppa), dp = PPA_PAGE(dst_ppa);
+
+    if (sb >= BLOCKS_PER_CHIP || db >= BLOCKS_PER_CHIP || !bad_table) return NAND_ERR_INVALID;
+    if (bad_table[db]) return NAND_ERR_BADBLOCK;
+
+    // erased source는 0xFF 그대로 program
+    const uint8_t *data = NULL, *oob = new_oob;
+    if (page_is_written(sb, sp)) {
+        data = nand_data_ptr(sb, sp, 0);
+        if (!oob) oob = nand_oob_ptr(sb, sp, 0);
+    }
+    time_lock_acquire();
+    nand_time_copyback(sb, db);
+    time_lock_release();
+    return nand_program_page(db, dp, data, oob);
+}
 
-    if (block >= BLOCKS_PER_CHIP || !nand_device) return NAND_ERR_INVALID;
-    
-    if (data) memcpy(data, nand_device[block].pages[page].data, NAND_PAGE_SIZE);
-    if (oob)  memcpy(oob, nand_device[block].pages[page].oob, NAND_OOB_SIZE);
+int nand_read_multi(const ppa_t *ppas, int n, uint8_t *data, uint8_t *oob) {
+    if (!bad_table || n < 0) return NAND_ERR_INVALID;
+
+    for (int i = 0; i < n; i++) {
+        if (ppas[i] >= (ppa_t)NAND_TOTAL_PAGES) return NAND_ERR_INVALID;
+    }
+    // 모든 read를 한꺼번에 issue -> 서로 다른 die는 병렬로 진행, host는 마지막 완료까지 대기
+    size_t bytes = (data ? NAND_PAGE_SIZE : 0) + (oob ? NAND_OOB_SIZE : 0);
+    if (timing_on) {
+        time_lock_acquire();
+        uint64_t done = host_clock;
+        for (int i = 0; i < n; i++) {
+            done = max_u64(done, nand_time_read(PPA_BLOCK(ppas[i]), bytes));
+        }
+        host_clock = done;
+        time_lock_release();
+    }
+    for (int i = 0; i < n; i++) {
+        nand_read_page(PPA_BLOCK(ppas[i]), PPA_PAGE(ppas[i]),
+                       data ? data + (size_t)i * NAND_PAGE_SIZE : NULL,
+                       oob ? oob + (size_t)i * NAND_OOB_SIZE : NULL);
+    }
+    return NAND_SUCCESS;
+}
+
+int nand_write_seq(ppa_t start, int n, const uint8_t *data, const uint8_t *oob) {
+    int block = PPA_BLOCK(start);
+    int page = PPA_PAGE(start);
+
+    // sequential burst는 한 block 안에서만
+    if (block >= BLOCKS_PER_CHIP || !bad_table || n < 0 || page + n > PAGES_PER_BLOCK) return NAND_ERR_INVALID;
+    if (bad_table[block]) return NAND_ERR_BADBLOCK;
+
+    for (int i = 0; i < n; i++) {
+        time_lock_acquire();
+        nand_time_prog(block, NAND_PAGE_SIZE + NAND_OOB_SIZE);
+        time_lock_release();
+        int ret = nand_program_page(block, page + i,
+                                    data ? data + (size_t)i * NAND_PAGE_SIZE : NULL,
+                                    oob ? oob + (size_t)i * NAND_OOB_SIZE : NULL);
+        if (ret != NAND_SUCCESS) return ret;
+    }
     return NAND_SUCCESS;
 }
 
 int nand_erase(int block) {
-    if (block >= BLOCKS_PER_CHIP || !nand_device) return NAND_ERR_INVALID;
+    if (block >= BLOCKS_PER_CHIP || !bad_table) return NAND_ERR_INVALID;
+
+    time_lock_acquire();
+    nand_time_erase(block);
+    time_lock_release();
+    __atomic_fetch_add(&erase_count[block], 1, __ATOMIC_RELAXED);
+
+    // state bitmap만 지우면 erased로 읽힘, 아래는 backing 반납
+    for (int w = 0; w < STATE_WORDS; w++) {
+        __atomic_store_n(&written_map[(size_t)block * STATE_WORDS + w], 0, __ATOMIC_RELEASE);
+    }
 
-    for (int j = 0; j < PAGES_PER_BLOCK; j++) {
-        memset(nand_device[block].pages[j].data, 0xFF, NAND_PAGE_SIZE);
-        memset(nand_device[block].pages[j].oob, 0xFF, NAND_OOB_SIZE);
-        nand_device[block].pages[j].is_written = 0;
+    if (backend == NAND_BACKEND_FILE) {
+        // hole punch: block 크기와 무관하게 디스크 블록만 반납
+        off_t data_off = (off_t)block * PAGES_PER_BLOCK * NAND_PAGE_SIZE;
+        off_t oob_off = (off_t)IMG_DATA_SIZE + (off_t)block * PAGES_PER_BLOCK * NAND_OOB_SIZE;
+        fallocate(img_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                  data_off, (off_t)PAGES_PER_BLOCK * NAND_PAGE_SIZE);
+        fallocate(img_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                  oob_off, (off_t)PAGES_PER_BLOCK * NAND_OOB_SIZE);
+    } else if (backend == NAND_BACKEND_SPARSE) {
+        uint8_t **slot = &sparse_data[(size_t)block * PAGES_PER_BLOCK];
+        for (int j = 0; j < PAGES_PER_BLOCK; j++) {
+            if (!slot[j]) continue;
+            free(slot[j]);
+            slot[j] = NULL;
+            __atomic_fetch_sub(&resident_pages, 1, __ATOMIC_RELAXED);
+        }
+        free(sparse_oob[block]);
+        sparse_oob[block] = NULL;
     }
     return NAND_SUCCESS;
 }
 
 void nand_exit(void) {
-    if (nand_device) {
-        free(nand_device);
-        nand_device = NULL;
+    if (img_map) {
+        msync(img_map, IMG_SIZE, MS_SYNC);
+        munmap(img_map, IMG_SIZE);
+        img_map = NULL;
+        // 아래 배열들은 image 안에 있음
+        page_data = page_oob = NULL;
+        written_map = NULL;
+        erase_count = NULL;
+        bad_table = NULL;
+    }
+    if (img_fd >= 0) {
+        close(img_fd);
+        img_fd = -1;
     }
+    if (sparse_data) {
+        for (uint32_t i = 0; i < NAND_TOTAL_PAGES; i++) free(sparse_data[i]);
+        free(sparse_data);
+        sparse_data = NULL;
+    }
+    if (sparse_oob) {
+        for (int i = 0; i < BLOCKS_PER_CHIP; i++) free(sparse_oob[i]);
+        free(sparse_oob);
+        sparse_oob = NULL;
+    }
+    free(page_data);
+    free(page_oob);
+    free(written_map);
+    free(erase_count);
+    free(bad_table);
+    page_data = page_oob = NULL;
+    written_map = NULL;
+    erase_count = NULL;
+    bad_table = NULL;
+    resident_pages = 0;
+    nand_set_geometry(&(nand_geometry_t){ 0 });
+}
+
+void nand_ppa_to_addr(ppa_t ppa, nand_addr_t *addr) {
+    int block = PPA_BLOCK(ppa);
+    addr->page = PPA_PAGE(ppa);
+    addr->channel = block % NAND_CHANNELS;
+    addr->die = (block / NAND_CHANNELS) % DIES_PER_CHANNEL;
+    addr->plane = (block / NAND_DIES) % PLANES_PER_DIE;
+    addr->block = block / (NAND_DIES * PLANES_PER_DIE);
+}
+
+ppa_t nand_addr_to_ppa(const nand_addr_t *addr) {
+    int block = ((addr->block * PLANES_PER_DIE + addr->plane) * DIES_PER_CHANNEL + addr->die)
+                * NAND_CHANNELS + addr->channel;
+    return (ppa_t)block * PAGES_PER_BLOCK + addr->page;
+}
+
+uint64_t nand_get_time(void) {
+    time_lock_acquire();
+    uint64_t t = host_clock;
+    time_lock_release();
+    return t;
+}
+
+uint64_t nand_get_finish_time(void) {
+    time_lock_acquire();
+    uint64_t t = host_clock;
+    for (int d = 0; d < NAND_DIES; d++) t = max_u64(t, die_busy_until[d]);
+    for (int c = 0; c < NAND_CHANNELS; c++) t = max_u64(t, ch_busy_until[c]);
+    time_lock_release();
+    return t;
+}
+
+uint64_t nand_get_die_busy(int die) {
+    if (die < 0 || die >= NAND_DIES) return 0;
+    return die_busy_total[die];
+}
+
+uint64_t nand_get_die_idle_time(int die) {
+    if (die < 0 || die >= NAND_DIES) return 0;
+    return die_busy_until[die];
+}
+
+void nand_wait_until(uint64_t t) {
+    if (!timing_on) return;
+    time_lock_acquire();
+    host_clock = max_u64(host_clock, t);
+    time_lock_release();
+}
+
+void nand_issue_at(uint64_t t) {
+    if (!timing_on) return;
+    time_lock_acquire();
+    host_clock = t;
+    time_lock_release();
+}
+
+uint64_t nand_get_channel_busy(int channel) {
+    if (channel < 0 || channel >= NAND_CHANNELS) return 0;
+    return ch_busy_total[channel];
+}
+
+int nand_timing_enabled(void) {
+    return timing_on;
+}
+
+int nand_image_reused(void) {
+    return img_reused;
+}
+
+int nand_is_written(ppa_t ppa) {
+    if (!bad_table || ppa >= (ppa_t)NAND_TOTAL_PAGES) return 0;
+    return page_is_written(PPA_BLOCK(ppa), PPA_PAGE(ppa));
+}
+
+uint32_t nand_get_erase_count(int block) {
+    if (!erase_count || block >= BLOCKS_PER_CHIP) return 0;
+    return __atomic_load_n(&erase_count[block], __ATOMIC_RELAXED);
+}
+
+int nand_mark_bad_block(int block) {
+    if (!bad_table || block >= BLOCKS_PER_CHIP) return NAND_ERR_INVALID;
+    __atomic_store_n(&bad_table[block], 1, __ATOMIC_RELAXED);
+    return NAND_SUCCESS;
 }
 
 int nand_is_bad_block(int block) {
-    if (!nand_device || block >= BLOCKS_PER_CHIP) return 1;
-    return nand_device[block].is_bad;
+    if (!bad_table || block >= BLOCKS_PER_CHIP) return 1;
+    return bad_table[block];
+}
+
+uint32_t nand_get_resident_pages(void) {
+    if (backend == NAND_BACKEND_FILE) {
+        // 실제 디스크에 할당된 용량 기준
+        struct stat st;
+        if (img_fd < 0 || fstat(img_fd, &st) != 0) return 0;
+        return (uint32_t)(((uint64_t)st.st_blocks * 512) / NAND_PAGE_SIZE);
+    }
+    return __atomic_load_n(&resident_pages, __ATOMIC_RELAXED);
 }
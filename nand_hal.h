@@ -4,13 +4,73 @@
 
 #include <stdint.h>
 
-#define NAND_PAGE_SIZE      4096    // 4KB Main Area
-#define NAND_OOB_SIZE       128     // 128B Spare Area
-#define PAGES_PER_BLOCK     64
-#define BLOCKS_PER_CHIP     1024
+// 기본 geometry (nand_config_t.geometry의 0 항목)
+#define NAND_DEFAULT_PAGE_SIZE          4096    // 4KB Main Area
+#define NAND_DEFAULT_OOB_SIZE           128     // 128B Spare Area
+#define NAND_DEFAULT_PAGES_PER_BLOCK    64
+#define NAND_DEFAULT_BLOCKS_PER_PLANE   128
+
+// Geometry: channel x die x plane x block
+// channel / die / plane 수는 timeline 배열과 striping이 걸려 있어 compile time 고정
+#define NAND_CHANNELS       4
+#define DIES_PER_CHANNEL    2
+#define PLANES_PER_DIE      1
+#define NAND_DIES           (NAND_CHANNELS * DIES_PER_CHANNEL)
+#define NAND_DEFAULT_BLOCKS (NAND_DIES * PLANES_PER_DIE * NAND_DEFAULT_BLOCKS_PER_PLANE)
+
+// runtime geometry 상한 (FTL의 block 단위 OOB buffer가 stack에 있음)
+#define NAND_MAX_PAGE_SIZE          65536
+#define NAND_MAX_OOB_SIZE           1024
+#define NAND_MAX_PAGES_PER_BLOCK    1024
+
+// 현재 geometry, nand_init()이 채움 (init 전 / nand_exit 후에는 기본값)
+typedef struct {
+    int page_size;
+    int oob_size;
+    int pages_per_block;
+    int blocks;             // total blocks, NAND_DIES * PLANES_PER_DIE의 배수
+    int block_shift;        // pages_per_block이 2의 거듭제곱이면 log2, 아니면 -1
+} nand_geo_t;
+
+extern nand_geo_t nand_geo;
+
+#ifdef NAND_FIXED_GEOMETRY
+// 기본 geometry 전용 build: 전부 compile time 상수 (nand_init은 다른 geometry를 거부)
+#define NAND_PAGE_SIZE      NAND_DEFAULT_PAGE_SIZE
+#define NAND_OOB_SIZE       NAND_DEFAULT_OOB_SIZE
+#define PAGES_PER_BLOCK     NAND_DEFAULT_PAGES_PER_BLOCK
+#define BLOCKS_PER_CHIP     NAND_DEFAULT_BLOCKS
+#define PPA_BLOCK(ppa)      ((int)((ppa) / PAGES_PER_BLOCK))
+#define PPA_PAGE(ppa)       ((int)((ppa) % PAGES_PER_BLOCK))
+#else
+#define NAND_PAGE_SIZE      (nand_geo.page_size)
+#define NAND_OOB_SIZE       (nand_geo.oob_size)
+#define PAGES_PER_BLOCK     (nand_geo.pages_per_block)
+#define BLOCKS_PER_CHIP     (nand_geo.blocks)   // total blocks in the device
+// 2의 거듭제곱 (기본 geometry 포함)이면 shift / mask, 아니면 나눗셈
+#define PPA_BLOCK(ppa)      (nand_geo.block_shift >= 0 ? (int)((uint32_t)(ppa) >> nand_geo.block_shift) \
+                                                       : (int)((uint32_t)(ppa) / (uint32_t)nand_geo.pages_per_block))
+#define PPA_PAGE(ppa)       (nand_geo.block_shift >= 0 ? (int)((uint32_t)(ppa) & (uint32_t)(nand_geo.pages_per_block - 1)) \
+                                                       : (int)((uint32_t)(ppa) % (uint32_t)nand_geo.pages_per_block))
+#endif
+#define BLOCKS_PER_DIE      (BLOCKS_PER_CHIP / NAND_DIES)
+#define BLOCKS_PER_PLANE    (BLOCKS_PER_DIE / PLANES_PER_DIE)
 
 typedef uint32_t ppa_t;    // PPA (Physical Page Address)
 
+// PPA = block * PAGES_PER_BLOCK + page
+// block index는 channel -> die -> plane 순으로 interleave 되므로
+// 연속된 block 번호는 서로 다른 channel / die에 위치함
+#define NAND_BLOCK_DIE(block)   ((block) % NAND_DIES)   // global die id (0 ~ NAND_DIES-1)
+
+typedef struct {
+    int channel;
+    int die;        // die within channel
+    int plane;
+    int block;      // block within plane
+    int page;
+} nand_addr_t;
+
 // Error Codes
 #define NAND_SUCCESS        0
 #define NAND_ERR_INVALID    -1  // wrong access to addtess
@@ -18,15 +78,80 @@ typedef uint32_t ppa_t;    // PPA (Physical Page Address)
 #define NAND_ERR_BADBLOCK   -3  // access to bad block
 #define NAND_ERR_NOT_ERASED -4  // try to write block not erased
 
+// Backing store
+typedef enum {
+    NAND_BACKEND_RAM = 0,   // whole device allocated at init
+    NAND_BACKEND_SPARSE,    // page buffer allocated on first write, freed on erase
+    NAND_BACKEND_FILE,      // sparse image file mmap'ed (MAP_SHARED), survives process exit
+} nand_backend_t;
+
+// Timing model (0 = default value)
+typedef struct {
+    uint32_t t_read_ns;     // tR: array -> page register
+    uint32_t t_prog_ns;     // tPROG: page register -> array
+    uint32_t t_erase_ns;    // tBERS
+    uint32_t t_byte_ps;     // channel bus transfer time per byte (ps)
+} nand_timing_t;
+
+// Geometry (0 = default value)
+typedef struct {
+    uint32_t page_size;         // main area bytes
+    uint32_t oob_size;          // spare area bytes (FTL은 앞 4B에 LBA를 기록)
+    uint32_t pages_per_block;
+    uint32_t blocks;            // total blocks
+    uint32_t op_percent;        // FTL over-provisioning: (물리 - logical) / logical, 0 = 기본 geometry와 같은 비율
+} nand_geometry_t;
+
+typedef struct {
+    nand_backend_t backend;
+    const char *image_path; // FILE backend: image file (created if missing)
+    int format;             // FILE backend: erase all blocks even if the image already exists
+                            // (an image of another geometry, or without a header, is always formatted)
+    nand_timing_t timing;
+    nand_geometry_t geometry;
+    int no_timing;          // ops complete instantly, virtual clock stays at 0
+} nand_config_t;
+
 // Command
-int nand_init(void);     // allcoate memory
+int nand_init(const nand_config_t *cfg);     // allcoate memory (cfg NULL = RAM backend)
 int nand_read(ppa_t ppa, uint8_t *data_buf, uint8_t *oob_buf);    // read memory
 int nand_write(ppa_t ppa, const uint8_t *data_buf, const uint8_t *oob_buf);    // write memory & check overwrite
 int nand_erase(int block_index); // erase
+// page -> page 이동 (NAND copy-back), host buffer 없이 data를 옮기고 OOB만 새로 씀
+// new_oob NULL = source OOB 유지. 같은 die 안에서는 channel transfer 없음
+int nand_copyback(ppa_t src_ppa, ppa_t dst_ppa, const uint8_t *new_oob);
+
+// Batched command
+// data / oob buffers are n consecutive pages (NAND_PAGE_SIZE / NAND_OOB_SIZE each), NULL = skip
+// read_multi: every ppa is bounds-checked first, then all reads are issued together (different dies overlap)
+int nand_read_multi(const ppa_t *ppas, int n, uint8_t *data_buf, uint8_t *oob_buf);
+// write_seq: must stay in one block, bounds / bad block check once per call
+int nand_write_seq(ppa_t start, int n, const uint8_t *data_buf, const uint8_t *oob_buf);
 void nand_exit(void); // memory free
 
+// Geometry / timeline
+// 각 die / channel은 자신의 busy timeline을 가지고, 서로 다른 die의 동작은 겹쳐서 진행됨
+// read는 완료(data out)까지 host가 대기, program / erase는 die가 명령을 받을 때까지만 대기
+void nand_ppa_to_addr(ppa_t ppa, nand_addr_t *addr);
+ppa_t nand_addr_to_ppa(const nand_addr_t *addr);
+uint64_t nand_get_time(void);           // host virtual clock (ns)
+uint64_t nand_get_finish_time(void);    // virtual time when every die is idle (ns)
+uint64_t nand_get_die_busy(int die);    // accumulated busy time of a die (ns)
+uint64_t nand_get_die_idle_time(int die);   // virtual time when the die finishes queued work
+void nand_wait_until(uint64_t t);       // host idles until virtual time t
+// 다음 명령의 발행 시각을 t로 설정 (되돌리기 가능)
+// queue에서 같은 시각에 꺼낸 명령들을 각각 t에서 시작시키면 die / channel timeline이 충돌만 직렬화함
+void nand_issue_at(uint64_t t);
+uint64_t nand_get_channel_busy(int channel);    // accumulated bus transfer time (ns)
+int nand_timing_enabled(void);
+// FTL mount: 기존 image를 다시 열었으면 FTL이 OOB에서 상태를 복원
+int nand_image_reused(void);            // 1 = FILE backend가 기존 image를 format 없이 열었음
+int nand_is_written(ppa_t ppa);         // program 된 page인지 (timing 없음)
+
 // Debug
-uint32_t nand_get_erase_count(int blcok_index);    // debug for erase count
+uint32_t nand_get_erase_count(int block_index);    // 누적 erase 횟수 (FILE backend는 image에 저장)
 int nand_is_bad_block(int block_index);    // check if it is bad block
+int nand_mark_bad_block(int block_index);  // grown bad block (program 실패), 이후 program / copy-back 거부, FILE image에 저장
+uint32_t nand_get_resident_pages(void);    // pages currently backed by memory
 
 #endif
@@ -0,0 +1,259 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "nvme.h"
+
+// controller가 한 arbitration round에서 queue 하나로부터 가져가는 최대 명령 수
+#define NVME_ARB_BURST  16
+
+// ring index는 계속 증가시키고 slot = index % depth (full / empty 구분이 쉬움)
+// 한 칸은 비워 둠: SQ / CQ 모두 최대 depth - 1 개
+typedef struct {
+    nvme_sqe_t *sq;
+    nvme_cqe_t *cq;
+    uint64_t *sq_stamp;         // doorbell 시각 (slot 별)
+
+    // host 쪽
+    uint32_t sq_tail;           // 다음에 쓸 SQ 자리 (doorbell 전까지 controller는 모름)
+    uint32_t cq_head;
+    uint64_t host_time;         // host가 마지막으로 본 completion 시각 (virtual), 다음 submit 시각
+
+    // doorbell register (host -> controller), atomic
+    uint32_t sq_tail_db;
+    uint32_t cq_head_db;
+
+    // controller 쪽
+    uint32_t sq_head;           // atomic, host가 SQ 공간 계산에 읽음
+    uint32_t cq_tail;
+} nvme_queue_t;
+
+static nvme_queue_t queues[NVME_MAX_QUEUES];
+static int nr_queues = 0;
+static uint32_t queue_depth = 0;
+static int use_virtual_time = 0;
+
+static pthread_t dispatcher;
+static int dispatcher_running = 0;     // db_lock 아래에서 바꿈
+// 할 일이 없으면 dispatcher는 doorbell을 기다림 (SQ tail, CQ head, 정지 요청마다 db_seq 증가)
+static pthread_mutex_t db_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t db_cv = PTHREAD_COND_INITIALIZER;
+static uint32_t db_seq = 0;
+
+static uint64_t wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// phase bit: ring을 홀수 번째 돌 때 1
+static inline uint8_t ring_phase(uint32_t index) {
+    return (uint8_t)(((index / queue_depth) & 1) ^ 1);
+}
+
+// 명령 하나를 FTL로 실행, 완료 시각 반환 (virtual time이면 start에 발행)
+static uint16_t nvme_execute(const nvme_sqe_t *cmd, uint64_t start, uint64_t *done) {
+    int n = cmd->nlb + 1;
+    uint8_t *buf = (uint8_t *)cmd->buf;
+
+    *done = start;
+    if (cmd->opcode == NVME_CMD_FLUSH) return NVME_SC_SUCCESS;
+    if (cmd->opcode != NVME_CMD_READ && cmd->opcode != NVME_CMD_WRITE && cmd->opcode != NVME_CMD_DSM) {
+        return NVME_SC_INVALID_OPCODE;
+    }
+    if (cmd->slba >= LOGICAL_PAGES_COUNT || n > (int)(LOGICAL_PAGES_COUNT - cmd->slba)) return NVME_SC_LBA_RANGE;
+    if (cmd->opcode == NVME_CMD_DSM) {
+        // mapping만 바꾸므로 NAND 시간 없음
+        ftl_trim(cmd->slba, n);
+        return NVME_SC_SUCCESS;
+    }
+
+    if (cmd->opcode == NVME_CMD_WRITE && cmd->dspec > FTL_STREAMS) return NVME_SC_INVALID_FIELD;
+
+    if (use_virtual_time) nand_issue_at(start);
+    if (cmd->opcode == NVME_CMD_WRITE) {
+        int ret;
+        if (cmd->dspec) ret = ftl_write_stream(cmd->slba, n, buf, cmd->dspec - 1);
+        else if (n == 1) ret = ftl_write(cmd->slba, buf);
+        else ret = ftl_write_multi(cmd->slba, n, buf);
+        if (use_virtual_time) *done = nand_get_time();
+        return ret == 0 ? NVME_SC_SUCCESS : NVME_SC_WRITE_FAULT;
+    }
+
+    // read는 page 별로 같은 시각에 발행 -> 서로 다른 die면 겹쳐서 진행
+    for (int i = 0; i < n; i++) {
+        if (use_virtual_time) nand_issue_at(start);
+        ftl_read(cmd->slba + i, buf + (size_t)i * NAND_PAGE_SIZE);
+        if (use_virtual_time && nand_get_time() > *done) *done = nand_get_time();
+    }
+    return NVME_SC_SUCCESS;
+}
+
+static void nvme_post(nvme_queue_t *q, int qid, const nvme_sqe_t *cmd, uint16_t status,
+                      uint64_t stamp, uint64_t done) {
+    nvme_cqe_t *cqe = &q->cq[q->cq_tail % queue_depth];
+    cqe->cid = cmd->cid;
+    cqe->sqid = (uint16_t)qid;
+    cqe->sq_head = (uint16_t)(__atomic_load_n(&q->sq_head, __ATOMIC_RELAXED) % queue_depth);
+    cqe->status = status;
+    cqe->done_ns = done;
+    cqe->latency_ns = done > stamp ? done - stamp : 0;
+    // phase는 마지막에: host는 phase가 바뀐 것을 보고 나머지 필드를 읽음
+    __atomic_store_n(&cqe->phase, ring_phase(q->cq_tail), __ATOMIC_RELEASE);
+    q->cq_tail++;
+}
+
+static void nvme_doorbell(void) {
+    pthread_mutex_lock(&db_lock);
+    db_seq++;
+    pthread_cond_signal(&db_cv);
+    pthread_mutex_unlock(&db_lock);
+}
+
+// 모든 SQ를 한 바퀴 돌며 명령 처리, 처리한 명령 수 반환
+// stopping: host가 더 이상 reap 하지 않으므로 CQ가 차 있어도 실행하고 completion은 버림
+static int nvme_dispatch_round(int stopping) {
+    int handled = 0;
+
+    for (int qid = 0; qid < nr_queues; qid++) {
+        nvme_queue_t *q = &queues[qid];
+        uint32_t tail = __atomic_load_n(&q->sq_tail_db, __ATOMIC_ACQUIRE);
+        uint32_t cq_head = __atomic_load_n(&q->cq_head_db, __ATOMIC_ACQUIRE);
+
+        for (int burst = 0; burst < NVME_ARB_BURST && q->sq_head != tail; burst++) {
+            // CQ가 차 있으면 host가 reap 할 때까지 이 queue는 건너뜀
+            int cq_full = q->cq_tail - cq_head >= queue_depth - 1;
+            if (cq_full && !stopping) break;
+
+            uint32_t slot = q->sq_head % queue_depth;
+            nvme_sqe_t cmd = q->sq[slot];
+            uint64_t stamp = q->sq_stamp[slot];
+            uint64_t done;
+            uint16_t status = nvme_execute(&cmd, stamp, &done);
+            if (!use_virtual_time) done = wall_ns();
+
+            __atomic_store_n(&q->sq_head, q->sq_head + 1, __ATOMIC_RELEASE);
+            if (!cq_full) nvme_post(q, qid, &cmd, status, stamp, done);
+            handled++;
+        }
+    }
+    return handled;
+}
+
+static void *nvme_dispatch_main(void *arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&db_lock);
+        uint32_t seen = db_seq;
+        int running = dispatcher_running;
+        pthread_mutex_unlock(&db_lock);
+
+        // 정지 요청 후에도 이미 doorbell 된 명령은 처리하고 나감
+        if (nvme_dispatch_round(!running) > 0) continue;
+        if (!running) break;
+
+        // round 도중에 울린 doorbell이 있으면 바로 다시 훑음
+        pthread_mutex_lock(&db_lock);
+        while (db_seq == seen) pthread_cond_wait(&db_cv, &db_lock);
+        pthread_mutex_unlock(&db_lock);
+    }
+    return NULL;
+}
+
+int nvme_init(int nr, int depth) {
+    // depth는 2의 거듭제곱: index가 uint32를 넘어 wrap 해도 slot / phase가 이어짐
+    if (nr <= 0 || nr > NVME_MAX_QUEUES || depth < 2 || depth > NVME_MAX_DEPTH || (depth & (depth - 1))) return -1;
+
+    nr_queues = nr;
+    queue_depth = (uint32_t)depth;
+    use_virtual_time = nand_timing_enabled();
+    for (int i = 0; i < nr; i++) {
+        nvme_queue_t *q = &queues[i];
+        memset(q, 0, sizeof(*q));
+        q->sq = (nvme_sqe_t *)calloc(depth, sizeof(nvme_sqe_t));
+        q->cq = (nvme_cqe_t *)calloc(depth, sizeof(nvme_cqe_t));   // phase 0 = 아직 안 쓴 entry
+        q->sq_stamp = (uint64_t *)calloc(depth, sizeof(uint64_t));
+        if (!q->sq || !q->cq || !q->sq_stamp) {
+            nvme_exit();
+            return -1;
+        }
+        q->host_time = nand_get_time();
+    }
+
+    dispatcher_running = 1;
+    if (pthread_create(&dispatcher, NULL, nvme_dispatch_main, NULL) != 0) {
+        dispatcher_running = 0;
+        nvme_exit();
+        return -1;
+    }
+    printf("[NVMe] %d queue pair(s), depth %d, latency in %s time\n",
+           nr, depth, use_virtual_time ? "virtual" : "wall-clock");
+    return 0;
+}
+
+void nvme_exit(void) {
+    if (dispatcher_running) {
+        pthread_mutex_lock(&db_lock);
+        dispatcher_running = 0;
+        pthread_mutex_unlock(&db_lock);
+        nvme_doorbell();
+        pthread_join(dispatcher, NULL);
+    }
+    for (int i = 0; i < nr_queues; i++) {
+        free(queues[i].sq);
+        free(queues[i].cq);
+        free(queues[i].sq_stamp);
+        memset(&queues[i], 0, sizeof(queues[i]));
+    }
+    nr_queues = 0;
+}
+
+int nvme_sq_space(int qid) {
+    if (qid < 0 || qid >= nr_queues) return 0;
+    nvme_queue_t *q = &queues[qid];
+    uint32_t head = __atomic_load_n(&q->sq_head, __ATOMIC_ACQUIRE);
+    return (int)(queue_depth - 1 - (q->sq_tail - head));
+}
+
+int nvme_sq_push(int qid, const nvme_sqe_t *cmd) {
+    if (qid < 0 || qid >= nr_queues || nvme_sq_space(qid) <= 0) return -1;
+    nvme_queue_t *q = &queues[qid];
+    q->sq[q->sq_tail % queue_depth] = *cmd;
+    q->sq_tail++;
+    return 0;
+}
+
+void nvme_sq_ring(int qid) {
+    if (qid < 0 || qid >= nr_queues) return;
+    nvme_queue_t *q = &queues[qid];
+    uint32_t db = q->sq_tail_db;
+    uint64_t now = use_virtual_time ? q->host_time : wall_ns();
+
+    for (; db != q->sq_tail; db++) q->sq_stamp[db % queue_depth] = now;
+    __atomic_store_n(&q->sq_tail_db, q->sq_tail, __ATOMIC_RELEASE);
+    nvme_doorbell();
+}
+
+int nvme_cq_reap(int qid, nvme_cqe_t *cqes, int max) {
+    if (qid < 0 || qid >= nr_queues) return 0;
+    nvme_queue_t *q = &queues[qid];
+    int n = 0;
+
+    while (n < max) {
+        nvme_cqe_t *cqe = &q->cq[q->cq_head % queue_depth];
+        if (__atomic_load_n(&cqe->phase, __ATOMIC_ACQUIRE) != ring_phase(q->cq_head)) break;
+        cqes[n++] = *cqe;
+        q->cq_head++;
+    }
+    if (n == 0) return 0;
+
+    // closed loop host: 다음 submit은 본 completion 중 가장 늦은 시각 이후
+    for (int i = 0; i < n; i++) {
+        if (cqes[i].done_ns > q->host_time) q->host_time = cqes[i].done_ns;
+    }
+    __atomic_store_n(&q->cq_head_db, q->cq_head, __ATOMIC_RELEASE);
+    // CQ가 차서 멈춰 있던 queue를 다시 보게 함
+    nvme_doorbell();
+    return n;
+}
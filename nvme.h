@@ -0,0 +1,67 @@
+#ifndef NVME_H
+#define NVME_H
+
+#include <stdint.h>
+#include "ftl.h"
+
+// NVMe 스타일 front end
+// queue pair 마다 submission ring / completion ring과 doorbell을 두고,
+// controller(dispatcher thread)가 SQ들을 round robin으로 돌면서 FTL에 명령을 넘김
+//
+// host 쪽 순서
+//  1. nvme_sq_push()로 SQ tail 자리에 명령을 씀 (여러 개 가능)
+//  2. nvme_sq_ring()으로 SQ tail doorbell -> controller가 가져감
+//  3. nvme_cq_reap()으로 phase bit가 맞는 CQE를 꺼내고 CQ head doorbell 갱신
+// 한 queue pair는 한 host thread만 사용 (queue 끼리는 독립)
+
+#define NVME_MAX_QUEUES     16
+#define NVME_MAX_DEPTH      1024    // ring entry 수, 2의 거듭제곱 (한 칸은 full / empty 구분용)
+
+typedef enum {
+    NVME_CMD_FLUSH = 0x00,
+    NVME_CMD_WRITE = 0x01,
+    NVME_CMD_READ  = 0x02,
+    NVME_CMD_DSM   = 0x09,  // Dataset Management (deallocate): range list 대신 slba / nlb 한 구간을 ftl_trim
+} nvme_opcode_t;
+
+typedef enum {
+    NVME_SC_SUCCESS = 0,
+    NVME_SC_INVALID_OPCODE,
+    NVME_SC_LBA_RANGE,
+    NVME_SC_INVALID_FIELD,  // 없는 write stream (dspec)
+    NVME_SC_WRITE_FAULT,    // 일부 page를 쓰지 못함 (공간 없음 / program 실패)
+} nvme_status_t;
+
+// submission queue entry
+typedef struct {
+    uint16_t cid;           // host가 정하는 command id, CQE에 그대로 돌아옴
+    uint8_t opcode;         // nvme_opcode_t
+    uint32_t slba;
+    uint16_t nlb;           // page 수 (0 = 1 page, NVMe의 0-based 표기)
+    void *buf;              // nlb + 1 page 크기 (DSM은 사용 안 함)
+    uint8_t dspec;          // write: streams directive, stream + 1 (0 = hint 없음)
+} nvme_sqe_t;
+
+// completion queue entry
+typedef struct {
+    uint16_t cid;
+    uint16_t sqid;
+    uint16_t sq_head;       // controller가 가져간 SQ 위치 (host의 SQ 공간 회수용)
+    uint16_t status;        // nvme_status_t
+    uint8_t phase;          // ring을 한 바퀴 돌 때마다 뒤집힘
+    uint64_t latency_ns;    // doorbell -> completion, timing model이 있으면 virtual ns, 없으면 wall-clock ns
+    uint64_t done_ns;       // completion 시각 (latency_ns와 같은 clock)
+} nvme_cqe_t;
+
+// ftl_init 이후, dispatcher thread 시작
+// virtual latency는 dispatcher 하나가 명령을 doorbell 시각에 발행하는 모델 (GC thread를 같이 돌리면 근사치)
+int nvme_init(int nr_queues, int depth);
+// 이미 doorbell 된 명령은 처리한 뒤 정지 (ftl_exit 전에), 그때 CQ에 자리가 없는 completion은 버림
+void nvme_exit(void);
+
+int nvme_sq_push(int qid, const nvme_sqe_t *cmd);   // 0 = ok, -1 = SQ full
+void nvme_sq_ring(int qid);                         // SQ tail doorbell
+int nvme_cq_reap(int qid, nvme_cqe_t *cqes, int max);   // 꺼낸 CQE 수, CQ head doorbell 갱신
+int nvme_sq_space(int qid);                         // 더 넣을 수 있는 SQE 수 (없는 qid = 0)
+
+#endif